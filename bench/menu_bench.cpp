@@ -0,0 +1,250 @@
+// Host benchmark: runs scripted input through ESP32_MenuSystem::update()
+// against the mock U8G2 and reports the cost of every frame it draws.
+//
+//   make -C bench run
+#include <ESP32_MenuSystem.h>
+#include <chrono>
+
+static const uint8_t PIN_UP = 1;
+static const uint8_t PIN_DOWN = 2;
+static const uint8_t PIN_OK = 3;
+
+static const unsigned long TICK_MS = 1;       // Virtual time per update()
+static const unsigned long RELEASE_MS = 80;   // Idle time after each press
+
+// Totals over the frames drawn while a scenario runs
+struct FrameTotals {
+    unsigned long updates;
+    unsigned long frames;
+    double frameMicros;
+    unsigned long maxUpdateBytes;   // Most bytes sent by one update()
+    unsigned long drawCalls;
+    unsigned long glyphs;
+    unsigned long transfers;
+    unsigned long bytesSent;
+};
+
+class Bench {
+public:
+    Bench(U8G2& display, ESP32_MenuSystem& menu) : display(display), menu(menu) {
+        memset(&totals, 0, sizeof(totals));
+    }
+
+    // One update(). Its time counts as frame time if it drew a frame;
+    // transfers count wherever they happen (chunked flushes span updates).
+    void tick() {
+        U8G2Counters before = display.counters;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        menu.update();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        mockAdvanceMillis(TICK_MS);
+
+        double micros = std::chrono::duration<double, std::micro>(end - start).count();
+        unsigned long bytes = display.counters.bytesSent - before.bytesSent;
+        totals.updates++;
+        if (bytes > totals.maxUpdateBytes) totals.maxUpdateBytes = bytes;
+        totals.drawCalls += display.counters.drawCalls - before.drawCalls;
+        totals.glyphs += display.counters.glyphs - before.glyphs;
+        totals.transfers += display.counters.transfers - before.transfers;
+        totals.bytesSent += bytes;
+        unsigned long frames = display.counters.frames - before.frames;
+        // Screen info regions are drawn over the last frame, without a clear
+        if (frames == 0 && display.counters.drawCalls != before.drawCalls) frames = 1;
+        if (frames == 0) return;
+        totals.frames += frames;
+        totals.frameMicros += micros;
+    }
+
+    void idle(unsigned long ms) {
+        for (unsigned long t = 0; t < ms; t += TICK_MS) tick();
+    }
+
+    // Hold a button (active low) for holdMs, then release it
+    void press(uint8_t pin, unsigned long holdMs = 80) {
+        mockSetPin(pin, LOW);
+        idle(holdMs);
+        mockSetPin(pin, HIGH);
+        idle(RELEASE_MS);
+    }
+
+    FrameTotals totals;
+
+private:
+    U8G2& display;
+    ESP32_MenuSystem& menu;
+};
+
+static void report(const char* scenario, const char* displayName, const FrameTotals& totals) {
+    double frames = totals.frames ? (double)totals.frames : 1.0;
+    printf("%-14s %-13s %7lu %6lu %10.2f %9lu %9.1f %9.1f %9.2f %10.1f\n", scenario, displayName,
+           totals.updates, totals.frames, totals.frameMicros / frames, totals.maxUpdateBytes,
+           totals.drawCalls / frames, totals.glyphs / frames, totals.transfers / frames,
+           totals.bytesSent / frames);
+}
+
+// Display setups every scenario runs on
+struct DisplaySetup {
+    const char* name;
+    uint8_t tileRowsPerPage;
+    bool partialUpdates;
+    uint8_t frameRate;          // 0 = uncapped
+    uint16_t animationMs;       // 0 = no animation
+    uint8_t chunkRows;          // Tile rows per update(), 0 = whole frames
+};
+
+static const DisplaySetup displaySetups[] = {
+    { "full+partial", 0, true, 0, 0, 0 },
+    { "full", 0, false, 0, 0, 0 },
+    { "page/1", 1, false, 0, 0, 0 },
+    { "anim@60fps", 0, true, 60, 120, 0 },
+    { "chunked/2", 0, true, 0, 0, 2 },
+};
+
+static const char* const itemNames[] = {
+    "Brightness", "Contrast", "Volume", "Balance", "Treble", "Bass", "Timer", "Alarm",
+    "Network", "Bluetooth", "Storage", "Battery", "Display", "Sound", "About", "Reset"
+};
+
+// Scroll a 16-item menu to the bottom and back up
+static void scrollScenario(Bench& bench, ESP32_MenuSystem& menu) {
+    int root = menu.addMenu("Settings");
+    for (int i = 0; i < 16; i++) menu.addMenuItem(root, itemNames[i]);
+    menu.begin();
+    bench.idle(10);
+
+    for (int i = 0; i < 15; i++) bench.press(PIN_DOWN);
+    for (int i = 0; i < 15; i++) bench.press(PIN_UP);
+}
+
+// Sweep a float value: hold UP through the repeat ramp, then step down
+static float sweepValue = 0.0f;
+
+static void sweepScenario(Bench& bench, ESP32_MenuSystem& menu) {
+    static FloatValueAdjuster adjuster(&sweepValue, 0.1f, 0.0f, 1000.0f, 1, "V", false);
+    sweepValue = 0.0f;
+
+    int root = menu.addMenu("Output");
+    menu.addValueMenuItem(root, "Voltage", &adjuster);
+    menu.addMenuItem(root, "Current");
+    menu.begin();
+    bench.idle(10);
+
+    bench.press(PIN_OK);
+    bench.press(PIN_UP, 5000);
+    for (int i = 0; i < 20; i++) bench.press(PIN_DOWN);
+    bench.press(PIN_OK);
+}
+
+// Enter 16 nested menus, then leave them through their Back items
+static void goBackItem(void* context) {
+    static_cast<ESP32_MenuSystem*>(context)->goBack();
+}
+
+static void deepScenario(Bench& bench, ESP32_MenuSystem& menu) {
+    static const int DEPTH = 16;
+    static char titles[DEPTH][12];
+    int levels[DEPTH];
+    for (int level = 0; level < DEPTH; level++) {
+        snprintf(titles[level], sizeof(titles[level]), "Level %d", level);
+        levels[level] = menu.addMenu(titles[level]);
+    }
+    for (int level = 0; level < DEPTH; level++) {
+        menu.addMenuItem(levels[level], "Deeper", level + 1 < DEPTH ? levels[level + 1] : -1);
+        menu.addMenuItemWithContext(levels[level], "Back", goBackItem, &menu);
+        for (int i = 0; i < 4; i++) menu.addMenuItem(levels[level], itemNames[i]);
+    }
+    menu.begin();
+    bench.idle(10);
+
+    for (int level = 0; level + 1 < DEPTH; level++) bench.press(PIN_OK);
+    for (int level = 0; level + 1 < DEPTH; level++) {
+        // Cursor returns to "Deeper" on the way back
+        bench.press(PIN_DOWN);
+        bench.press(PIN_OK);
+    }
+}
+
+// Scroll 60 rows into a 500-entry data source list
+class LogSource : public MenuDataSource {
+public:
+    int count() override { return 500; }
+    void getItem(int index, char* buffer, size_t size) override {
+        snprintf(buffer, size, "%04d boot ok", index);
+    }
+};
+
+static void listScenario(Bench& bench, ESP32_MenuSystem& menu) {
+    static LogSource source;
+    int root = menu.addMenu("Device");
+    int log = menu.addListMenu("Log", &source);
+    menu.addMenuItem(root, "Log", log);
+    menu.begin();
+    bench.idle(10);
+
+    bench.press(PIN_OK);
+    for (int i = 0; i < 60; i++) bench.press(PIN_DOWN);
+}
+
+// Idle for 5s on a menu with a temperature readout refreshed at 2 Hz
+static U8G2* infoDisplay = nullptr;
+
+static void drawTemperature() {
+    infoDisplay->setCursor(96, 62);
+    infoDisplay->print("21.5C");
+}
+
+static void infoScenario(Bench& bench, ESP32_MenuSystem& menu) {
+    int root = menu.addMenu("Status");
+    for (int i = 0; i < 4; i++) menu.addMenuItem(root, itemNames[i]);
+    menu.addScreenInfoRegion(root, 96, 56, 32, 8, drawTemperature, 500);
+    menu.begin();
+    bench.idle(5000);
+}
+
+#ifdef MENU_ENABLE_STATS
+// The library's own counters for the run: section times in microseconds
+// of host time, latency in virtual time
+static void reportStats(ESP32_MenuSystem& menu) {
+    MenuStats stats = menu.getStats();
+    double mhz = stats.cpuMhz ? (double)stats.cpuMhz : 1.0;
+    printf("  getStats: input %.2f draw %.2f flush %.2f us avg, latency %lu us avg %lu p99 "
+           "(%u samples), %lu frames, %lu skipped\n",
+           stats.input.avg / mhz, stats.draw.avg / mhz, stats.flush.avg / mhz,
+           (unsigned long)stats.latency.avg, (unsigned long)stats.latency.p99, stats.latency.samples,
+           (unsigned long)stats.framesRendered, (unsigned long)stats.framesSkipped);
+}
+#endif
+
+typedef void (*Scenario)(Bench& bench, ESP32_MenuSystem& menu);
+
+static void run(const char* name, Scenario scenario) {
+    for (size_t i = 0; i < sizeof(displaySetups) / sizeof(displaySetups[0]); i++) {
+        const DisplaySetup& setup = displaySetups[i];
+        U8G2 display(128, 64, setup.tileRowsPerPage);
+        ESP32_MenuSystem menu(&display, PIN_UP, PIN_DOWN, PIN_OK);
+        menu.setPartialUpdates(setup.partialUpdates);
+        menu.setRefreshMode(REFRESH_ON_CHANGE, 0);
+        menu.setFrameRate(setup.frameRate);
+        menu.setAnimation(setup.animationMs);
+        menu.setChunkedFlush(setup.chunkRows);
+
+        infoDisplay = &display;
+        Bench bench(display, menu);
+        scenario(bench, menu);
+        report(name, setup.name, bench.totals);
+        #ifdef MENU_ENABLE_STATS
+        reportStats(menu);
+        #endif
+    }
+}
+
+int main() {
+    printf("%-14s %-13s %7s %6s %10s %9s %9s %9s %9s %10s\n", "scenario", "display",
+           "updates", "frames", "us/frame", "max B/u", "draws/f", "glyphs/f", "xfers/f", "bytes/f");
+    run("scroll-16", scrollScenario);
+    run("float-sweep", sweepScenario);
+    run("deep-nav", deepScenario);
+    run("list-500", listScenario);
+    run("info-2hz", infoScenario);
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Host mock of the Arduino core, just enough for ESP32_MenuSystem.
+// Time is virtual: it only moves when the benchmark advances it.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+#define IRAM_ATTR
+
+#define MOCK_PIN_COUNT 64
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+uint32_t getCpuFrequencyMhz();
+
+// Cycle counter for MENU_ENABLE_STATS, from the host clock at 240 MHz
+class EspClass {
+public:
+    uint32_t getCycleCount();
+};
+extern EspClass ESP;
+
+typedef void (*voidFuncPtrArg)(void*);
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, voidFuncPtrArg handler, void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Benchmark control
+void mockAdvanceMillis(unsigned long ms);
+void mockSetPin(uint8_t pin, int level);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* text);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
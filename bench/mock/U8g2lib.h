@@ -0,0 +1,78 @@
+// Host mock of U8G2. Nothing is rasterized: the mock counts draw calls,
+// buffer transfers and the bytes they would put on the display bus. Only
+// drawPixel() writes the buffer, in U8g2's tile layout.
+#pragma once
+#include <Arduino.h>
+
+// Mock fonts: { glyph width, max height, ascent, descent }
+extern const uint8_t u8g2_font_4x6_tr[];
+extern const uint8_t u8g2_font_5x8_tr[];
+extern const uint8_t u8g2_font_6x12_tr[];
+extern const uint8_t u8g2_font_10x20_tr[];
+
+struct U8G2Counters {
+    unsigned long drawCalls;     // Primitives and strings drawn
+    unsigned long glyphs;        // Characters drawn (decoded from the font on hardware)
+    unsigned long frames;        // clearBuffer() / firstPage()
+    unsigned long transfers;     // sendBuffer(), updateDisplayArea() and pages
+    unsigned long bytesSent;     // Buffer bytes sent to the display
+};
+
+class U8G2 : public Print {
+public:
+    // tileRowsPerPage = 0 for a full buffer, 1 or 2 like the _1/_2 constructors
+    U8G2(uint16_t width = 128, uint16_t height = 64, uint8_t tileRowsPerPage = 0);
+
+    void begin() {}
+    void clearBuffer();
+    void sendBuffer();
+    void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+    void firstPage();
+    uint8_t nextPage();
+
+    void setFont(const uint8_t* font) { currentFont = font; }
+    int8_t getAscent() const { return (int8_t)currentFont[2]; }
+    int8_t getDescent() const { return (int8_t)currentFont[3]; }
+    int8_t getMaxCharHeight() const { return (int8_t)currentFont[1]; }
+    int8_t getMaxCharWidth() const { return (int8_t)currentFont[0]; }
+    uint16_t getStrWidth(const char* text) const { return strlen(text) * currentFont[0]; }
+
+    void setCursor(int16_t x, int16_t y) { tx = x; ty = y; }
+    void setDrawColor(uint8_t color) { drawColor = color; }
+    void setClipWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {}
+    void setMaxClipWindow() {}
+    void setContrast(uint8_t value) {}
+    void setPowerSave(uint8_t enable) {}
+    void drawHLine(int16_t x, int16_t y, int16_t w) { counters.drawCalls++; }
+    void drawVLine(int16_t x, int16_t y, int16_t h) { counters.drawCalls++; }
+    void drawBox(int16_t x, int16_t y, int16_t w, int16_t h) { counters.drawCalls++; }
+    void drawFrame(int16_t x, int16_t y, int16_t w, int16_t h) { counters.drawCalls++; }
+    uint16_t drawStr(int16_t x, int16_t y, const char* text);
+    void drawXBM(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* bitmap) { counters.drawCalls++; }
+    void drawPixel(int16_t x, int16_t y);
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+
+    uint16_t getDisplayWidth() const { return width; }
+    uint16_t getDisplayHeight() const { return height; }
+    uint8_t getBufferTileWidth() const { return (width + 7) / 8; }
+    uint8_t getBufferTileHeight() const;
+    uint8_t getBufferCurrTileRow() const { return pageRow; }
+    uint8_t* getBufferPtr() { return buffer; }
+
+    int16_t tx;                                    // Print cursor, public as in U8G2
+    int16_t ty;
+
+    U8G2Counters counters;
+    void resetCounters() { memset(&counters, 0, sizeof(counters)); }
+
+private:
+    uint16_t width;
+    uint16_t height;
+    uint8_t tileRowsPerPage;
+    uint8_t pageRow;
+    const uint8_t* currentFont;
+    uint8_t drawColor;
+    uint8_t buffer[256 / 8 * 128];                 // Largest supported panel
+};
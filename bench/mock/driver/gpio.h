@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+int gpio_get_level(gpio_num_t pin);
+int gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type);
+int gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type);
+int gpio_wakeup_disable(gpio_num_t pin);
+int gpio_intr_enable(gpio_num_t pin);
+int gpio_intr_disable(gpio_num_t pin);
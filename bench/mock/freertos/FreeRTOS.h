@@ -0,0 +1,15 @@
+// Host mock of FreeRTOS: no tasks, the render task never starts
+#pragma once
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portNUM_PROCESSORS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
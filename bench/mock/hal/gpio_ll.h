@@ -0,0 +1,12 @@
+#pragma once
+#include <driver/gpio.h>
+
+// GPIO register block; the mock keeps only the per-pin interrupt type
+// and reads levels from the simulated pins
+struct gpio_pin_reg_t { uint32_t int_type; };
+struct gpio_dev_t { gpio_pin_reg_t pin[64]; };
+extern gpio_dev_t GPIO;
+
+static inline int gpio_ll_get_level(gpio_dev_t* hw, uint32_t gpio_num) {
+    return gpio_get_level((gpio_num_t)gpio_num);
+}
@@ -0,0 +1,195 @@
+// Implementation of the host mocks
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_sleep.h>
+#include <nvs.h>
+#include <chrono>
+
+const uint8_t u8g2_font_4x6_tr[] = { 4, 6, 5, (uint8_t)-1 };
+const uint8_t u8g2_font_5x8_tr[] = { 5, 8, 6, (uint8_t)-1 };
+const uint8_t u8g2_font_6x12_tr[] = { 6, 12, 9, (uint8_t)-2 };
+const uint8_t u8g2_font_10x20_tr[] = { 10, 20, 15, (uint8_t)-4 };
+
+// Arduino core
+
+static unsigned long mockMillis = 0;
+static int mockPins[MOCK_PIN_COUNT];
+
+unsigned long millis() { return mockMillis; }
+unsigned long micros() { return mockMillis * 1000UL; }
+void delay(unsigned long ms) { mockMillis += ms; }
+void mockAdvanceMillis(unsigned long ms) { mockMillis += ms; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < MOCK_PIN_COUNT) mockPins[pin] = (mode == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < MOCK_PIN_COUNT ? mockPins[pin] : LOW;
+}
+
+void mockSetPin(uint8_t pin, int level) {
+    if (pin < MOCK_PIN_COUNT) mockPins[pin] = level;
+}
+
+int gpio_get_level(gpio_num_t pin) {
+    return digitalRead((uint8_t)pin);
+}
+
+gpio_dev_t GPIO;
+
+int gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    if (pin < MOCK_PIN_COUNT) GPIO.pin[pin].int_type = type;
+    return 0;
+}
+int gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) { return gpio_set_intr_type(pin, type); }
+int gpio_wakeup_disable(gpio_num_t) { return 0; }
+int gpio_intr_enable(gpio_num_t) { return 0; }
+int gpio_intr_disable(gpio_num_t) { return 0; }
+
+esp_err_t esp_sleep_enable_gpio_wakeup() { return 0; }
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t) { return 0; }
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t) { return 0; }
+esp_err_t esp_light_sleep_start() { return 0; }
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_UNDEFINED; }
+
+esp_err_t nvs_open(const char*, nvs_open_mode_t, nvs_handle_t*) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_get_u32(nvs_handle_t, const char*, uint32_t*) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_u32(nvs_handle_t, const char*, uint32_t) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_commit(nvs_handle_t) { return ESP_ERR_NVS_NOT_FOUND; }
+void nvs_close(nvs_handle_t) {}
+
+uint32_t getCpuFrequencyMhz() { return 240; }
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount() {
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint32_t)(elapsed.count() * 240 / 1000);
+}
+
+void attachInterruptArg(uint8_t, voidFuncPtrArg, void*, int) {}
+void detachInterrupt(uint8_t) {}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) written += write(*buffer++);
+    return written;
+}
+
+size_t Print::print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+
+size_t Print::print(int value) { return print((long)value); }
+size_t Print::print(unsigned int value) { return print((unsigned long)value); }
+
+size_t Print::print(long value) {
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", value);
+    return print(text);
+}
+
+size_t Print::print(unsigned long value) {
+    char text[24];
+    snprintf(text, sizeof(text), "%lu", value);
+    return print(text);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return print(text);
+}
+
+// U8G2
+
+U8G2::U8G2(uint16_t width, uint16_t height, uint8_t tileRowsPerPage)
+    : tx(0), ty(0), width(width), height(height), tileRowsPerPage(tileRowsPerPage), pageRow(0),
+      currentFont(u8g2_font_5x8_tr), drawColor(1) {
+    resetCounters();
+    memset(buffer, 0, sizeof(buffer));
+}
+
+uint8_t U8G2::getBufferTileHeight() const {
+    return tileRowsPerPage ? tileRowsPerPage : (height + 7) / 8;
+}
+
+void U8G2::clearBuffer() {
+    counters.frames++;
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void U8G2::sendBuffer() {
+    counters.transfers++;
+    counters.bytesSent += getBufferTileWidth() * getBufferTileHeight() * 8UL;
+}
+
+void U8G2::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    counters.transfers++;
+    counters.bytesSent += tw * th * 8UL;
+}
+
+void U8G2::firstPage() {
+    counters.frames++;
+    pageRow = 0;
+}
+
+uint8_t U8G2::nextPage() {
+    sendBuffer();
+    pageRow += getBufferTileHeight();
+    return pageRow < (height + 7) / 8;
+}
+
+void U8G2::drawPixel(int16_t x, int16_t y) {
+    counters.drawCalls++;
+    if (x < 0 || y < 0 || x >= width || y >= getBufferTileHeight() * 8) return;
+    uint8_t& column = buffer[(y / 8) * getBufferTileWidth() * 8 + x];
+    uint8_t mask = 1 << (y % 8);
+    column = drawColor ? (column | mask) : (column & ~mask);
+}
+
+uint16_t U8G2::drawStr(int16_t x, int16_t y, const char* text) {
+    counters.drawCalls++;
+    counters.glyphs += strlen(text);
+    return getStrWidth(text);
+}
+
+// Characters printed one at a time (print(char)) count as one call each
+size_t U8G2::write(uint8_t c) {
+    counters.drawCalls++;
+    counters.glyphs++;
+    tx += currentFont[0];
+    return 1;
+}
+
+// A printed string is one draw call
+size_t U8G2::write(const uint8_t* buffer, size_t size) {
+    counters.drawCalls++;
+    counters.glyphs += size;
+    tx += size * currentFont[0];
+    return size;
+}
+
+// FreeRTOS: single threaded, task creation fails so the menu renders inline
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = nullptr;
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t) {}
+void vTaskDelay(TickType_t ticks) { mockMillis += ticks; }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+
+static int mockMutex;
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return &mockMutex; }
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+void vSemaphoreDelete(SemaphoreHandle_t) {}
@@ -0,0 +1,24 @@
+// Host mock of the ESP-IDF NVS API: there is no flash, so opening a
+// namespace fails and settings are neither loaded nor saved
+#pragma once
+#include <stdint.h>
+
+typedef int esp_err_t;
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode_t;
+
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* handle);
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* value);
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void nvs_close(nvs_handle_t handle);
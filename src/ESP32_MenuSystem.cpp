@@ -1,32 +1,297 @@
 // ESP32_MenuSystem.cpp
 #include "ESP32_MenuSystem.h"
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <esp_sleep.h>
+#include <nvs.h>
 
-// Button mode constructor
-ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display, int upPin, int downPin, int okPin)
-    : display(u8g2Display), 
-      inputMode(INPUT_BUTTONS),
-      buttonUpPin(upPin), 
-      buttonDownPin(downPin), 
-      buttonOkPin(okPin),
-      encoder(nullptr),
-      standardFont(u8g2_font_5x8_tr),
-      titleFont(u8g2_font_6x12_tr),
-      valueFont(u8g2_font_10x20_tr),
-      screenWidth(128),
-      screenHeight(64) {
-    
-    // Initialize other parameters
-    menuCount = 0;
+#ifdef MENU_INPUT_ENCODER
+  #ifdef USE_ESP32_ENCODER
+    #include <ESP32Encoder.h>
+  #else
+    #include "InterruptEncoder.h"
+  #endif
+#endif
+
+#ifdef MENU_ENABLE_STATS
+  #if __has_include(<esp_cpu.h>)
+    #include <esp_cpu.h>
+    #define MENU_STATS_CYCLES() ((uint32_t)esp_cpu_get_cycle_count())
+  #else
+    #define MENU_STATS_CYCLES() ((uint32_t)ESP.getCycleCount())
+  #endif
+
+// Rolling sample window of one timing
+struct ESP32_MenuSystem::TimingWindow {
+    uint32_t samples[MENU_STATS_WINDOW];
+    uint16_t count;
+    uint16_t next;
+};
+#endif
+
+#ifdef MENU_INPUT_ENCODER
+struct ESP32_MenuSystem::EncoderInput {
+    #ifdef USE_ESP32_ENCODER
+    ESP32Encoder* device;
+    #else
+    InterruptEncoder* device;
+    #endif
+    int pinA;
+    int pinB;
+    long lastValue;
+    int sensitivity;          // Number of encoder steps to register as one menu movement
+    long accumulator;         // Accumulator for encoder ticks
+    unsigned long lastStepTime;
+    EncoderAccelerationStep acceleration[MAX_ENCODER_ACCEL_STEPS];
+    uint8_t accelerationCount;
+};
+#endif
+
+#ifdef MENU_INPUT_REMOTE
+struct ESP32_MenuSystem::RemoteState {
+    enum { RX_SYNC, RX_LENGTH, RX_PAYLOAD, RX_CHECK };
+    struct ValueRef {
+        int16_t menuIndex;
+        uint16_t item;
+    };
+    Stream* stream;
+    bool replies;
+    uint8_t rxState;
+    uint8_t rxLength;
+    uint8_t rxCount;
+    uint8_t rxCheck;
+    uint8_t rx[MENU_REMOTE_FRAME_SIZE];
+    int16_t sentMenu;         // Last reported state
+    int16_t sentCursor;
+    uint8_t sentMode;
+    ValueRef values[MENU_REMOTE_MAX_VALUES];   // Reported with the reply
+    uint8_t valueCount;
+};
+#endif
+
+struct ESP32_MenuSystem::InputQueue {
+    struct Event {
+        uint8_t button;
+        bool active;
+        unsigned long timestamp;  // millis() at the edge
+    };
+    Event events[MENU_INPUT_QUEUE_SIZE];
+    volatile uint8_t head;    // Written by the ISR only
+    volatile uint8_t tail;    // Written by update() only
+};
+
+struct ESP32_MenuSystem::PersistState {
+    struct Value {
+        ValueAdjuster* adjuster;
+        const char* key;
+        uint32_t saved;       // Value bits as last loaded or saved
+    };
+    Value values[MAX_PERSISTED_VALUES];
+    uint8_t count;
+    const char* nvsNamespace;
+    unsigned long delay;
+    unsigned long changedAt;
+    uint32_t revision;        // Revisions of the persisted adjusters last seen
+    bool dirty;
+    bool saveNow;             // Save on the next update() without waiting
+};
+
+struct ESP32_MenuSystem::ListRowCache {
+    int index;                // -1 = empty
+    char text[MENU_LIST_TEXT_LENGTH];
+};
+
+// Screen identifiers used to detect full-screen changes between frames
+enum {
+    SCREEN_NONE = 0,
+    SCREEN_MENU_LIST,
+    SCREEN_VALUE_ADJUST,
+    SCREEN_BOOL_ADJUST,
+    SCREEN_OPTION_LIST,
+    SCREEN_EDITOR,
+    SCREEN_ERROR
+};
+
+// FNV-1a style mixing for region content keys
+static uint32_t hashMix(uint32_t hash, uint32_t value) {
+    hash ^= value;
+    return hash * 16777619UL;
+}
+
+static uint32_t hashString(uint32_t hash, const char* str) {
+    while (*str) {
+        hash = hashMix(hash, (uint8_t)*str++);
+    }
+    return hashMix(hash, 0);
+}
+
+// Block alignment inside the arena (menus and items hold pointers)
+static const size_t ARENA_ALIGN = sizeof(void*);
+
+bool MenuArena::allocate(size_t bytes) {
+    release();
+    base = static_cast<uint8_t*>(malloc(bytes));
+    if (base == nullptr) return false;
+    owned = true;
+    size = bytes;
+    front = 0;
+    back = bytes;
+    return true;
+}
+
+void MenuArena::use(uint8_t* buffer, size_t bytes) {
+    release();
+    if (buffer == nullptr) return;
+
+    // Start on an aligned address so blocks can hold pointers
+    size_t skew = (ARENA_ALIGN - ((uintptr_t)buffer % ARENA_ALIGN)) % ARENA_ALIGN;
+    if (skew > bytes) return;
+    base = buffer + skew;
+    size = bytes - skew;
+    front = 0;
+    back = size;
+}
+
+void MenuArena::release() {
+    if (owned) free(base);
+    base = nullptr;
+    owned = false;
+    size = front = back = 0;
+    freeList = nullptr;
+    freeBytes = 0;
+}
+
+static size_t alignArena(size_t bytes) {
+    return (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+// Give a block's space back, merged with the free blocks next to it.
+// Space at the end of the front region shrinks it; other space goes on
+// the free list (pieces too small to hold a link are lost).
+void MenuArena::recycle(uint8_t* block, size_t bytes) {
+    if (block == nullptr || bytes == 0) return;
+    bytes = alignArena(bytes);
+
+    for (FreeBlock** link = &freeList; *link != nullptr; ) {
+        uint8_t* other = reinterpret_cast<uint8_t*>(*link);
+        if (other + (*link)->size != block && block + bytes != other) {
+            link = &(*link)->next;
+            continue;
+        }
+        if (other < block) block = other;
+        bytes += (*link)->size;
+        freeBytes -= (*link)->size;
+        *link = (*link)->next;
+        link = &freeList;  // The merged block may now touch another one
+    }
+
+    if (block + bytes >= base + front) {
+        front = block - base;
+        return;
+    }
+    if (bytes < sizeof(FreeBlock)) return;
+
+    FreeBlock* freed = reinterpret_cast<FreeBlock*>(block);
+    freed->size = bytes;
+    freed->next = freeList;
+    freeList = freed;
+    freeBytes += bytes;
+}
+
+// First freed block that fits; the rest of it stays free
+void* MenuArena::takeFree(size_t bytes) {
+    bytes = alignArena(bytes);
+    for (FreeBlock** link = &freeList; *link != nullptr; link = &(*link)->next) {
+        FreeBlock* found = *link;
+        if (found->size < bytes) continue;
+
+        size_t rest = found->size - bytes;
+        *link = found->next;
+        freeBytes -= found->size;
+        if (rest >= sizeof(FreeBlock)) {
+            recycle(reinterpret_cast<uint8_t*>(found) + bytes, rest);
+        }
+        return found;
+    }
+    return nullptr;
+}
+
+void* MenuArena::grow(void* block, size_t oldSize, size_t newSize) {
+    uint8_t* data = static_cast<uint8_t*>(block);
+    if (base == nullptr) return nullptr;
+
+    // The last block grows in place
+    if (data != nullptr && data + oldSize == base + front &&
+        (size_t)(data - base) + newSize <= back) {
+        front = (data - base) + newSize;
+        return data;
+    }
+
+    // Otherwise move it into a freed block or to the end
+    uint8_t* moved = static_cast<uint8_t*>(takeFree(newSize));
+    if (moved == nullptr) {
+        size_t start = alignArena(front);
+        if (start + newSize > back) return nullptr;
+        moved = base + start;
+        front = start + newSize;
+    }
+    if (data != nullptr) {
+        memcpy(moved, data, oldSize);
+        recycle(data, oldSize);
+    }
+    return moved;
+}
+
+const char* MenuArena::copyString(const char* text) {
+    if (text == nullptr) text = "";
+    size_t length = strlen(text) + 1;
+    if (base == nullptr || back < front + length) return nullptr;
+
+    back -= length;
+    memcpy(base + back, text, length);
+    return reinterpret_cast<const char*>(base + back);
+}
+
+// Input mode: a constant when only one backend is compiled in, so the
+// branches on it fold away
+inline InputMode ESP32_MenuSystem::activeInput() const {
+    #if defined(MENU_INPUT_FIXED) && defined(MENU_INPUT_BUTTONS)
+    return INPUT_BUTTONS;
+    #elif defined(MENU_INPUT_FIXED) && defined(MENU_INPUT_ENCODER)
+    return INPUT_ENCODER;
+    #elif defined(MENU_INPUT_FIXED)
+    return INPUT_SINGLE_BUTTON;
+    #else
+    return inputMode;
+    #endif
+}
+
+InputMode ESP32_MenuSystem::getInputMode() const {
+    return activeInput();
+}
+
+// Defaults shared by all constructors
+void ESP32_MenuSystem::initDefaults() {
+    standardFont = u8g2_font_5x8_tr;
+    titleFont = u8g2_font_6x12_tr;
+    valueFont = u8g2_font_10x20_tr;
+    screenWidth = 128;
+    screenHeight = 64;
+
+    model = &ownModel;
+    model->arena.allocate(MENU_ARENA_SIZE);
+    modelRevision = model->revision;
     currentMenuIndex = 0;
     cursorPosition = 0;
+    scrollOffset = 0;
+    navigationDepth = 0;
     isValueAdjustMode = false;
     currentValueAdjuster = nullptr;
+    currentEditor = nullptr;
 
-    // Initialize button trigger types to default (TRIGGER_LOW)
-    buttonUpTriggerType = TRIGGER_LOW;
-    buttonDownTriggerType = TRIGGER_LOW;
-    buttonOkTriggerType = TRIGGER_LOW;
-    encoderButtonTriggerType = TRIGGER_LOW;
+    glyphCache = nullptr;
+    glyphClock = 0;
+    glyphCapture = false;
 
     // Initial layout calculation
     titleHeight = 12;
@@ -37,100 +302,211 @@ ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display, int upPin, int downPin, in
     scrollIndicatorWidth = 3;
     menuItemPadding = 2; 
 
+    fontMetricsValid = false;
+    standardMetrics = titleMetrics = valueMetrics = FontMetrics();
+    fontGeneration = 1;
+    for (uint8_t i = 0; i < MAX_VISIBLE_ROWS; i++) {
+        rowValueCache[i].adjuster = nullptr;
+        rowValueCache[i].text.fontGeneration = 0;
+    }
+    adjustValueWidth.fontGeneration = 0;
+    adjustMaxWidth.fontGeneration = 0;
+    listRows = nullptr;
+    listCacheMenu = -1;
+    updateRowPositions();
+
     displayOffsetX = 0;
     displayOffsetY = 0;
     useDisplayOffset = false;
     
-    // Initialize button states
-    buttonUpState = false;
-    buttonDownState = false;
-    buttonOkState = false;
-    lastButtonUpState = false;
-    lastButtonDownState = false;
-    lastButtonOkState = false;
-    
-    lastDebounceTime = 0;
-    debounceDelay = 50; // 50ms debounce
-    
+    // No buttons attached yet; trigger types default to TRIGGER_LOW
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        buttons[i].owner = this;
+        buttons[i].pin = -1;
+        buttons[i].trigger = TRIGGER_LOW;
+        buttons[i].state = false;
+        buttons[i].lastState = false;
+        buttons[i].debounceMode = DEBOUNCE_TIME;
+        buttons[i].debounceDelay = 50; // 50ms debounce
+        buttons[i].lastChange = 0;
+        buttons[i].lastSample = 0;
+        buttons[i].integral = 0;
+        buttons[i].pressedAt = 0;
+        buttons[i].nextRepeat = 0;
+        buttons[i].longPressFired = false;
+        buttons[i].wakePress = false;
+    }
+
+    // Hold-to-repeat: value adjusting only
+    repeatDelay = 500;
+    repeatInterval = 100;
+    repeatRamp10x = 2000;
+    repeatRamp100x = 4000;
+    repeatInNavigation = false;
+
+    longPressThreshold = 3000;
+    singleShortPressIsUp = false;
+
+    remote = nullptr;
+
+    renderTaskEnabled = false;
+    renderTaskCore = 0;
+    renderTaskPriority = 1;
+    renderTaskStackSize = 4096;
+    renderTaskHandle = nullptr;
+    renderTaskStopping = false;
+    stateMutex = nullptr;
+
+    interruptInput = false;
+    inputQueue = nullptr;
+    inputQueueOverflows = 0;
+
+    flushChunkRows = 0;
+    flushRow = 0;
+    flushActive = false;
+
+    infoRegions = nullptr;
+    infoRegionCount = 0;
+    regionFramePending = false;
+
+    mirrorSink = nullptr;
+    mirrorOut = nullptr;
+    mirrorShadow = nullptr;
+    mirrorDelta = false;
+    mirrorKeyFrame = true;
+    mirrorXor = false;
+
+    frameInterval = 0;
+    lastFrameTime = 0;
+    frameTime = 0;
+    animationDuration = 0;
+    animationMenu = -1;
+    animating = false;
+    scrollMotion.from = scrollMotion.to = 0;
+    scrollMotion.start = 0;
+    cursorMotion = scrollMotion;
+
+    idleState = IDLE_ACTIVE;
+    lastActivity = 0;
+    dimAfter = 0;
+    displayOffAfter = 0;
+    activeContrast = 255;
+    dimContrast = 16;
+    idlePollInterval = 20;
+    lastPoll = 0;
+    lightSleepWhenOff = false;
+    panelUpdatePending = false;
+
+    encoder = nullptr;
+
     previousMillis = 0;
     interval = 1000; // Default 1 second interval
-    
+
+    needsRedraw = true;
+    refreshMode = REFRESH_TIMED;
+    shownAdjusterKey = 0;
+
+    persist = nullptr;
+
+    renderMode = MENU_DEFAULT_RENDER_MODE;
+    pageBufferMode = (renderMode == RENDER_PAGE_BUFFER);
+    partialUpdates = true;
+    bufferLayout = BUFFER_OTHER;
+    needsFullFlush = true;
+    frameFullFlush = true;
+    screenKey = SCREEN_NONE;
+    for (uint8_t i = 0; i < REGION_COUNT; i++) regionKeys[i] = 0;
+    
+    timingWindows = nullptr;
+    #ifdef MENU_ENABLE_STATS
+    timingWindows = static_cast<TimingWindow*>(calloc(TIMING_COUNT, sizeof(TimingWindow)));
+    #endif
+    framesRendered = 0;
+    framesSkipped = 0;
+    inputPending = false;
+    inputMarkMicros = 0;
+    inputDrained = false;
+    oldestInputMillis = 0;
+    statsOverlay = false;
+
     errorCode = 0;
     errorMessage[0] = '\0';
+}
+
+// Button mode constructor
+#ifdef MENU_INPUT_BUTTONS
+ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display, int upPin, int downPin, int okPin)
+    : display(u8g2Display) {
+    initDefaults();
+    inputMode = INPUT_BUTTONS;
+
+    buttons[BUTTON_ID_UP].pin = upPin;
+    buttons[BUTTON_ID_DOWN].pin = downPin;
+    buttons[BUTTON_ID_OK].pin = okPin;
     
     // Set up button pins
-    pinMode(buttonUpPin, INPUT_PULLUP);
-    pinMode(buttonDownPin, INPUT_PULLUP);
-    pinMode(buttonOkPin, INPUT_PULLUP);
+    pinMode(upPin, INPUT_PULLUP);
+    pinMode(downPin, INPUT_PULLUP);
+    pinMode(okPin, INPUT_PULLUP);
 }
+#endif
 
+#ifdef MENU_INPUT_ENCODER
 // Encoder mode constructor
 ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display, int encoderA, int encoderB, int encoderBtn, bool useEncoder, int sensitivity)
-    : display(u8g2Display), 
-      inputMode(INPUT_ENCODER),
-      encoderPinA(encoderA), 
-      encoderPinB(encoderB), 
-      encoderButtonPin(encoderBtn),
-      encoderSensitivity(sensitivity),
-      encoderAccumulator(0),
-      standardFont(u8g2_font_5x8_tr),
-      titleFont(u8g2_font_6x12_tr),
-      valueFont(u8g2_font_10x20_tr),
-      screenWidth(128),
-      screenHeight(64) {
-    
-    menuCount = 0;
-    currentMenuIndex = 0;
-    cursorPosition = 0;
-    isValueAdjustMode = false;
-    currentValueAdjuster = nullptr;
+    : display(u8g2Display) {
+    initDefaults();
+    inputMode = INPUT_ENCODER;
+    buttons[BUTTON_ID_ENCODER].pin = encoderBtn;
 
-    // Initialize button trigger types to default (TRIGGER_LOW)
-    buttonUpTriggerType = TRIGGER_LOW;
-    buttonDownTriggerType = TRIGGER_LOW;
-    buttonOkTriggerType = TRIGGER_LOW;
-    encoderButtonTriggerType = TRIGGER_LOW;
+    encoder = new EncoderInput();
+    encoder->pinA = encoderA;
+    encoder->pinB = encoderB;
+    encoder->lastValue = 0;
+    encoder->sensitivity = (sensitivity > 0) ? sensitivity : 1;
+    encoder->accumulator = 0;
+    encoder->lastStepTime = 0;
 
-    // Initial layout calculation based on default values
-    titleHeight = 12;
-    separatorY = 12;
-    menuStartY = 22;
-    lineHeight = 10;
-    menuItemsVisible = 4;
-    scrollIndicatorWidth = 3;
-    menuItemPadding = 2; 
+    // Default acceleration curve (steps per second -> multiplier)
+    static const EncoderAccelerationStep defaultAcceleration[] = {
+        { 10, 4 }, { 25, 16 }, { 50, 64 }
+    };
+    setEncoderAcceleration(defaultAcceleration, 3);
 
-    displayOffsetX = 0;
-    displayOffsetY = 0;
-    useDisplayOffset = false;
-    
     // Initialize encoder
     #ifdef USE_ESP32_ENCODER
-    encoder = new ESP32Encoder();
+    encoder->device = new ESP32Encoder();
     ESP32Encoder::useInternalWeakPullResistors = puType::up;
-    encoder->attachHalfQuad(encoderPinA, encoderPinB);
-    encoder->setCount(0);
+    encoder->device->attachHalfQuad(encoder->pinA, encoder->pinB);
+    encoder->device->setCount(0);
     #else
-    encoder = new InterruptEncoder();
-    encoder->attach(encoderPinA, encoderPinB);
+    encoder->device = new InterruptEncoder();
+    encoder->device->attach(encoder->pinA, encoder->pinB);
     #endif
-    lastEncoderValue = 0;
-    
-    // Initialize encoder button state
-    encoderButtonState = false;
-    lastEncoderButtonState = false;
-    
-    lastDebounceTime = 0;
-    debounceDelay = 50; // 50ms debounce
-    
-    previousMillis = 0;
-    interval = 1000; // Default 1 second interval
-    
-    errorCode = 0;
-    errorMessage[0] = '\0';
     
     // Set up button pin
-    pinMode(encoderButtonPin, INPUT_PULLUP);
+    pinMode(encoderBtn, INPUT_PULLUP);
+}
+#endif
+
+#ifdef MENU_INPUT_SINGLE_BUTTON
+// Single button constructor: the button lives in the OK slot
+ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display, int buttonPin, bool shortPressIsUp)
+    : display(u8g2Display) {
+    initDefaults();
+    inputMode = INPUT_SINGLE_BUTTON;
+
+    buttons[BUTTON_ID_OK].pin = buttonPin;
+    singleShortPressIsUp = shortPressIsUp;
+    pinMode(buttonPin, INPUT_PULLUP);
+}
+#endif
+
+// No pins: the view is driven through the API (or the remote channel)
+ESP32_MenuSystem::ESP32_MenuSystem(U8G2* u8g2Display)
+    : display(u8g2Display) {
+    initDefaults();
+    inputMode = INPUT_BUTTONS;
 }
 
 // Implementation of configureButtonTriggers
@@ -139,75 +515,268 @@ void ESP32_MenuSystem::configureButtonTriggers(ButtonTriggerType upTrigger,
                                                ButtonTriggerType okTrigger,
                                                ButtonTriggerType encoderTrigger)
 {
-    buttonUpTriggerType = upTrigger;
-    buttonDownTriggerType = downTrigger;
-    buttonOkTriggerType = okTrigger;
-    encoderButtonTriggerType = encoderTrigger;
+    buttons[BUTTON_ID_UP].trigger = upTrigger;
+    buttons[BUTTON_ID_DOWN].trigger = downTrigger;
+    buttons[BUTTON_ID_OK].trigger = okTrigger;
+    buttons[BUTTON_ID_ENCODER].trigger = encoderTrigger;
 }
 
 // Implementation of setButtonTrigger
 void ESP32_MenuSystem::setButtonTrigger(ButtonID buttonId, ButtonTriggerType triggerType)
 {
-    switch (buttonId)
-    {
-    case BUTTON_ID_UP:
-        buttonUpTriggerType = triggerType;
-        break;
-    case BUTTON_ID_DOWN:
-        buttonDownTriggerType = triggerType;
-        break;
-    case BUTTON_ID_OK:
-        buttonOkTriggerType = triggerType;
-        break;
-    case BUTTON_ID_ENCODER:
-        encoderButtonTriggerType = triggerType;
-        break;
+    if (buttonId >= 0 && buttonId < BUTTON_COUNT) {
+        buttons[buttonId].trigger = triggerType;
     }
 }
 
 // Destructor
 // Update the destructor in ESP32_MenuSystem.cpp
 ESP32_MenuSystem::~ESP32_MenuSystem() {
+    stopRenderTask();
+    if (stateMutex != nullptr) {
+        vSemaphoreDelete(stateMutex);
+    }
+    enableInterruptInput(false);
+
+    free(mirrorShadow);
+    free(glyphCache);
+    free(timingWindows);
+    free(inputQueue);
+    free(persist);
+    free(remote);
+    free(listRows);
+    free(infoRegions);
+
+    #ifdef MENU_INPUT_ENCODER
     // Clean up encoder if allocated
     if (encoder != nullptr) {
+        delete encoder->device;
         delete encoder;
     }
-    
-    // Clean up any dynamically allocated callbacks
-    for (int i = 0; i < menuCount; i++) {
-        for (int j = 0; j < menus[i].itemCount; j++) {
-            if (menus[i].items[j].callback != nullptr) {
-                delete menus[i].items[j].callback;
-                menus[i].items[j].callback = nullptr;
-            }
+    #endif
+}
+
+bool ESP32_MenuSystem::useArena(uint8_t* buffer, size_t size) {
+    // Existing menus point into the current arena
+    if (model != &ownModel || model->menuCount > 0 || buffer == nullptr) return false;
+
+    model->arena.use(buffer, size);
+    model->menus = nullptr;
+    model->menuCapacity = 0;
+    model->menuIdIndex = nullptr;
+    model->menuIdIndexSize = 0;
+    return model->arena.capacity() > 0;
+}
+
+bool ESP32_MenuSystem::shareMenus(ESP32_MenuSystem& owner) {
+    if (&owner == this || owner.model == &ownModel || ownModel.menuCount > 0) return false;
+
+    lockState();
+    ownModel.arena.release();
+    model = owner.model;
+    modelRevision = model->revision;
+
+    // Start at the root of the shared tree
+    currentMenuIndex = 0;
+    cursorPosition = 0;
+    scrollOffset = 0;
+    navigationDepth = 0;
+    listCacheMenu = -1;
+    unlockState();
+    invalidate();
+    return true;
+}
+
+// Store a menu record, growing the directory (doubling) when it is full
+int ESP32_MenuSystem::appendMenu(const Menu& menu) {
+    if (model->menuCount == model->menuCapacity) {
+        int newCapacity = (model->menuCapacity > 0) ? model->menuCapacity * 2 : 4;
+        void* block = model->arena.grow(model->menus, model->menuCapacity * sizeof(Menu), newCapacity * sizeof(Menu));
+        if (block == nullptr) {
+            // Try growing by just one before giving up
+            newCapacity = model->menuCapacity + 1;
+            block = model->arena.grow(model->menus, model->menuCapacity * sizeof(Menu), newCapacity * sizeof(Menu));
+            if (block == nullptr) return -1;
         }
+        model->menus = static_cast<Menu*>(block);
+        model->menuCapacity = newCapacity;
     }
+
+    model->menus[model->menuCount] = menu;
+    model->menus[model->menuCount].owner = model;
+    indexMenuId(menu.id, model->menuCount);
+    model->menuCount++;
+    return model->menuCount - 1;
 }
 
-int ESP32_MenuSystem::addMenu(const char* title) {
-    if (menuCount < MAX_MENU_DEPTH) {
-        menus[menuCount] = Menu(title, menuCount);
-        menuCount++;
-        return menuCount - 1;
+// Largest id kept in the direct lookup table (2 bytes per id)
+static const int MAX_INDEXED_MENU_ID = 255;
+
+void ESP32_MenuSystem::indexMenuId(int id, int menuIndex) {
+    if (id < 0 || id > MAX_INDEXED_MENU_ID) return;
+
+    if (id >= model->menuIdIndexSize) {
+        int newSize = (model->menuIdIndexSize > 0) ? model->menuIdIndexSize : 8;
+        while (newSize <= id) newSize *= 2;
+        if (newSize > MAX_INDEXED_MENU_ID + 1) newSize = MAX_INDEXED_MENU_ID + 1;
+
+        void* block = model->arena.grow(model->menuIdIndex, model->menuIdIndexSize * sizeof(int16_t), newSize * sizeof(int16_t));
+        if (block == nullptr) return;  // findMenuById() still finds it by scanning
+        model->menuIdIndex = static_cast<int16_t*>(block);
+        for (int i = model->menuIdIndexSize; i < newSize; i++) {
+            model->menuIdIndex[i] = -1;
+        }
+        model->menuIdIndexSize = newSize;
     }
-    return -1;
+
+    // Like the scan, the first menu with a given id wins
+    if (model->menuIdIndex[id] < 0) {
+        model->menuIdIndex[id] = menuIndex;
+    }
+}
+
+// Add an item to a runtime menu: the name goes to the string pool and the
+// item block grows in place while it is the arena's last block
+bool MenuModel::appendItem(Menu& menu, const MenuItem& item) {
+    if (menu.isConstant() || menu.dataSource) return false;
+
+    if (menu.itemCount == menu.itemCapacity) {
+        if (menu.itemCapacity == 0xFFFF) return false;
+        uint16_t newCapacity = (menu.itemCapacity > 0) ? menu.itemCapacity * 2 : 4;
+        if (newCapacity < menu.itemCapacity) newCapacity = 0xFFFF;
+        void* block = arena.grow(const_cast<MenuItem*>(menu.items),
+                                 menu.itemCapacity * sizeof(MenuItem), newCapacity * sizeof(MenuItem));
+        if (block == nullptr) {
+            newCapacity = menu.itemCapacity + 1;
+            block = arena.grow(const_cast<MenuItem*>(menu.items),
+                               menu.itemCapacity * sizeof(MenuItem), newCapacity * sizeof(MenuItem));
+            if (block == nullptr) return false;
+        }
+        menu.items = static_cast<MenuItem*>(block);
+        menu.itemCapacity = newCapacity;
+    }
+
+    const char* storedName = arena.copyString(item.name);
+    if (storedName == nullptr) return false;
+
+    MenuItem& stored = const_cast<MenuItem*>(menu.items)[menu.itemCount];
+    stored = item;
+    stored.name = storedName;
+    menu.itemCount++;
+    revision++;
+    return true;
 }
 
-void ESP32_MenuSystem::addMenuItem(int menuIndex, const char* name, int nextMenuId, MenuCallback* callback) {
-    if (menuIndex >= 0 && menuIndex < menuCount) {
-        menus[menuIndex].addItem(name, nextMenuId, callback);
+void Menu::addItem(const char* name, int nextMenuId, MenuCallback* callback, ValueAdjuster* adjuster) {
+    if (owner != nullptr) {
+        owner->appendItem(*this, MenuItem(name, nextMenuId, callback, adjuster));
     }
 }
 
-void ESP32_MenuSystem::addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster) {
-    if (menuIndex >= 0 && menuIndex < menuCount) {
-        menus[menuIndex].addItem(name, -1, nullptr, adjuster);
+bool ESP32_MenuSystem::appendMenuItem(int menuIndex, const MenuItem& item) {
+    if (menuIndex < 0 || menuIndex >= model->menuCount) return false;
+    if (!model->appendItem(model->menus[menuIndex], item)) return false;
+
+    if (menuIndex == currentMenuIndex) needsRedraw = true;
+    return true;
+}
+
+int ESP32_MenuSystem::addMenu(const char* title) {
+    const char* storedTitle = model->arena.copyString(title);
+    if (storedTitle == nullptr) return -1;
+
+    return appendMenu(Menu(storedTitle, model->menuCount));
+}
+
+int ESP32_MenuSystem::addStaticMenu(const char* title, const MenuItem* items, int count, int id) {
+    if (items == nullptr || count <= 0) return -1;
+
+    return appendMenu(Menu(title, (id >= 0) ? id : model->menuCount, items, count));
+}
+
+int ESP32_MenuSystem::addListMenu(const char* title, MenuDataSource* source, int id) {
+    if (source == nullptr) return -1;
+
+    const char* storedTitle = model->arena.copyString(title);
+    if (storedTitle == nullptr) return -1;
+
+    Menu menu(storedTitle, (id >= 0) ? id : model->menuCount);
+    menu.dataSource = source;
+    return appendMenu(menu);
+}
+
+bool ESP32_MenuSystem::addMenuTree(const MenuDefinition* definitions, int count) {
+    for (int i = 0; i < count; i++) {
+        const MenuDefinition& definition = definitions[i];
+        if (addStaticMenu(definition.title, definition.items, definition.itemCount, definition.id) < 0) {
+            return false;
+        }
     }
+    return true;
+}
+
+bool ESP32_MenuSystem::addMenuItem(int menuIndex, const char* name, int nextMenuId, MenuCallback* callback) {
+    return appendMenuItem(menuIndex, MenuItem(name, nextMenuId, callback));
+}
+
+bool ESP32_MenuSystem::addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster) {
+    return appendMenuItem(menuIndex, MenuItem(name, -1, nullptr, adjuster));
+}
+
+bool ESP32_MenuSystem::addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster,
+                                        ValueEditor* editor) {
+    return appendMenuItem(menuIndex, MenuItem(name, adjuster, editor));
 }
 
 void ESP32_MenuSystem::setMenuMaxVisibleItems(int menuIndex, int maxItems) {
-    if (menuIndex >= 0 && menuIndex < menuCount) {
-        menus[menuIndex].maxVisibleItems = maxItems;
+    if (menuIndex >= 0 && menuIndex < model->menuCount) {
+        model->menus[menuIndex].maxVisibleItems = maxItems;
+        model->revision++;
+        if (menuIndex == currentMenuIndex) needsRedraw = true;
+    }
+}
+
+static_assert(MENU_LIST_CACHE_ROWS >= MAX_VISIBLE_ROWS + 2 * MENU_LIST_PREFETCH,
+              "MENU_LIST_CACHE_ROWS must hold the visible rows and the prefetch");
+
+// Text of one data source row, fetched on a cache miss
+const char* ESP32_MenuSystem::listRowText(const Menu& menu, int index) {
+    if (listRows == nullptr) {
+        listRows = static_cast<ListRowCache*>(malloc(MENU_LIST_CACHE_ROWS * sizeof(ListRowCache)));
+        if (listRows == nullptr) return "";
+        listCacheMenu = -1;
+    }
+    if (listCacheMenu != currentMenuIndex) {
+        for (uint8_t i = 0; i < MENU_LIST_CACHE_ROWS; i++) {
+            listRows[i].index = -1;
+        }
+        listCacheMenu = currentMenuIndex;
+    }
+
+    ListRowCache& row = listRows[index % MENU_LIST_CACHE_ROWS];
+    if (row.index != index) {
+        row.text[0] = '\0';
+        menu.dataSource->getItem(index, row.text, sizeof(row.text));
+        row.text[sizeof(row.text) - 1] = '\0';
+        row.index = index;
+    }
+    return row.text;
+}
+
+// After a frame, fetch the rows just above and below the view, so the
+// next scroll step finds them cached
+void ESP32_MenuSystem::prefetchListRows() {
+    if (isValueAdjustMode || errorCode > 0) return;
+    Menu* currentMenu = getCurrentMenu();
+    if (!currentMenu || !currentMenu->dataSource || listCacheMenu != currentMenuIndex) return;
+
+    int itemCount = currentMenu->dataSource->count();
+    int first = scrollOffset - MENU_LIST_PREFETCH;
+    int last = scrollOffset + menuItemsVisible + MENU_LIST_PREFETCH;
+    if (first < 0) first = 0;
+    if (last > itemCount) last = itemCount;
+    for (int index = first; index < last; index++) {
+        listRowText(*currentMenu, index);
     }
 }
 
@@ -225,11 +794,121 @@ uint8_t ESP32_MenuSystem::getFontWidth(const uint8_t* font) {
     return display->getMaxCharWidth();
 }
 
+// Measure all three fonts once; drawing code uses these cached values
+void ESP32_MenuSystem::readFontMetrics(const uint8_t* font, FontMetrics& metrics) {
+    display->setFont(font);
+    metrics.ascent = display->getAscent();
+    metrics.descent = display->getDescent();
+    metrics.height = display->getMaxCharHeight();
+    metrics.width = display->getMaxCharWidth();
+}
+
+void ESP32_MenuSystem::cacheFontMetrics() {
+    if (display == nullptr) return;
+
+    readFontMetrics(standardFont, standardMetrics);
+    readFontMetrics(titleFont, titleMetrics);
+    readFontMetrics(valueFont, valueMetrics);
+    fontMetricsValid = true;
+
+    // Cached string widths were measured with the old fonts
+    fontGeneration++;
+    if (fontGeneration == 0) fontGeneration = 1;
+
+    updateRowPositions();
+}
+
+// Fixed-point formatting for the adjusters' decimal places model, used instead
+// of sprintf("%.Nf") to keep newlib's float printf off the render path.
+// Writes raw / 10^decimals (e.g. 1234, 2 -> "12.34") and returns the length.
+uint8_t ESP32_MenuSystem::formatFixed(char* buffer, size_t size, int64_t raw, uint8_t decimals) {
+    if (size == 0) return 0;
+
+    char digits[24];
+    uint8_t count = 0;
+    bool negative = raw < 0;
+    uint64_t magnitude = negative ? (uint64_t)(-(raw + 1)) + 1 : (uint64_t)raw;
+
+    // 32-bit division is much cheaper than 64-bit on the ESP32
+    if (magnitude <= 0xFFFFFFFFULL) {
+        uint32_t small = (uint32_t)magnitude;
+        do {
+            digits[count++] = '0' + (small % 10);
+            small /= 10;
+        } while (small > 0 || count <= decimals);
+    } else {
+        do {
+            digits[count++] = '0' + (uint8_t)(magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0 || count <= decimals);
+    }
+
+    size_t pos = 0;
+    if (negative && pos < size - 1) buffer[pos++] = '-';
+    while (count > 0 && pos < size - 1) {
+        if (count == decimals) {
+            buffer[pos++] = '.';
+            if (pos >= size - 1) break;
+        }
+        buffer[pos++] = digits[--count];
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+uint8_t ESP32_MenuSystem::formatValue(char* buffer, size_t size, float value, int decimals) {
+    static const float scales[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f };
+
+    if (decimals < 0) decimals = 0;
+    if (decimals > 6) decimals = 6;
+
+    if (value != value) {  // NaN
+        strncpy(buffer, "nan", size - 1);
+        buffer[size - 1] = '\0';
+        return strlen(buffer);
+    }
+
+    // Round half away from zero in single precision (hardware FPU)
+    float scaled = value * scales[decimals];
+    scaled += (scaled < 0.0f) ? -0.5f : 0.5f;
+    if (scaled > 9.2e18f || scaled < -9.2e18f) {
+        strncpy(buffer, "ovf", size - 1);
+        buffer[size - 1] = '\0';
+        return strlen(buffer);
+    }
+    return formatFixed(buffer, size, (int64_t)scaled, decimals);
+}
+
+// Width of text in the current font, measured only when the text (or the
+// fonts) changed since this cache slot was last used
+uint16_t ESP32_MenuSystem::measureText(TextWidthCache& cache, const char* text) {
+    if (cache.fontGeneration == fontGeneration && strcmp(cache.text, text) == 0) {
+        return cache.width;
+    }
+
+    uint16_t width = display->getStrWidth(text);
+    if (strlen(text) < sizeof(cache.text)) {
+        strcpy(cache.text, text);
+        cache.width = width;
+        cache.fontGeneration = fontGeneration;
+    }
+    return width;
+}
+
+// Precompute the baseline of every visible item row
+void ESP32_MenuSystem::updateRowPositions() {
+    uint8_t rowPitch = standardMetrics.height + menuItemPadding;
+    for (uint8_t i = 0; i < MAX_VISIBLE_ROWS; i++) {
+        rowY[i] = menuStartY + i * rowPitch;
+    }
+}
+
 // Update layout based on current font sizes
 void ESP32_MenuSystem::updateLayoutForFonts() {
     // Get heights of the fonts
-    uint8_t stdFontHeight = getFontHeight(standardFont);
-    uint8_t titleFontHeight = getFontHeight(titleFont);
+    cacheFontMetrics();
+    uint8_t stdFontHeight = standardMetrics.height;
+    uint8_t titleFontHeight = titleMetrics.height;
     
     // Adjust title height based on the title font
     titleHeight = titleFontHeight + 2; // Add a little padding
@@ -249,6 +928,9 @@ void ESP32_MenuSystem::updateLayoutForFonts() {
     
     // Ensure at least one item is visible
     if (menuItemsVisible < 1) menuItemsVisible = 1;
+    if (menuItemsVisible > MAX_VISIBLE_ROWS) menuItemsVisible = MAX_VISIBLE_ROWS;
+
+    updateRowPositions();
 }
 
 // Update screen size to also consider fonts
@@ -268,21 +950,28 @@ void ESP32_MenuSystem::setScreenSize(uint16_t width, uint16_t height) {
     
     // Ensure at least one item is visible
     if (menuItemsVisible < 1) menuItemsVisible = 1;
+    if (menuItemsVisible > MAX_VISIBLE_ROWS) menuItemsVisible = MAX_VISIBLE_ROWS;
     
     // Scroll indicator width
     scrollIndicatorWidth = 3;
+
+    cacheFontMetrics();
+
+    invalidate();
 }
 
 void ESP32_MenuSystem::setDisplayOffset(int16_t x, int16_t y) {
     displayOffsetX = x;
     displayOffsetY = y;
     useDisplayOffset = true;
+    invalidate();
 }
 
 void ESP32_MenuSystem::clearDisplayOffset() {
     displayOffsetX = 0;
     displayOffsetY = 0;
     useDisplayOffset = false;
+    invalidate();
 }
 
 void ESP32_MenuSystem::setLayoutParameters(uint8_t titleH, uint8_t sepY, uint8_t startY, uint8_t lineH) {
@@ -292,26 +981,18 @@ void ESP32_MenuSystem::setLayoutParameters(uint8_t titleH, uint8_t sepY, uint8_t
     lineHeight = lineH;
     
     // Calculate appropriate padding based on line height and font height
-    uint8_t stdFontHeight = getFontHeight(standardFont);
+    if (!fontMetricsValid) cacheFontMetrics();
+    uint8_t stdFontHeight = standardMetrics.height;
     menuItemPadding = (lineH > stdFontHeight) ? (lineH - stdFontHeight) : 0;
+    updateRowPositions();
+    invalidate();
 }
 
-// Update the moveUp method for BoolValueAdjuster
 void ESP32_MenuSystem::moveUp() {
+    needsRedraw = true;
+
     if (isValueAdjustMode && currentValueAdjuster) {
-        if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-            // Set temp value to true for boolean adjuster
-            BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(currentValueAdjuster);
-            boolAdjuster->setTempValue(true);
-            return;
-        }
-        
-        // Original value adjust handling
-        if (currentValueAdjuster) {
-            float value = currentValueAdjuster->getValue();
-            float increment = currentValueAdjuster->getIncrement();
-            currentValueAdjuster->setValue(value + increment);
-        }
+        adjustValueBy(1);
     } else {
         // Original menu navigation
         if (cursorPosition > 0) {
@@ -320,7 +1001,8 @@ void ESP32_MenuSystem::moveUp() {
             // Wrap around to bottom
             Menu* currentMenu = getCurrentMenu();
             if (currentMenu) {
-                cursorPosition = currentMenu->itemCount - 1;
+                cursorPosition = currentMenu->getItemCount() - 1;
+                if (cursorPosition < 0) cursorPosition = 0;
             }
         }
     }
@@ -328,25 +1010,15 @@ void ESP32_MenuSystem::moveUp() {
 
 // Update the moveDown method
 void ESP32_MenuSystem::moveDown() {
+    needsRedraw = true;
+
     if (isValueAdjustMode && currentValueAdjuster) {
-        if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-            // Set temp value to false for boolean adjuster
-            BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(currentValueAdjuster);
-            boolAdjuster->setTempValue(false);
-            return;
-        }
-        
-        // Original value adjust handling
-        if (currentValueAdjuster) {
-            float value = currentValueAdjuster->getValue();
-            float increment = currentValueAdjuster->getIncrement();
-            currentValueAdjuster->setValue(value - increment);
-        }
+        adjustValueBy(-1);
     } else {
         // Original menu navigation
         Menu* currentMenu = getCurrentMenu();
         if (currentMenu) {
-            if (cursorPosition < currentMenu->itemCount - 1) {
+            if (cursorPosition < currentMenu->getItemCount() - 1) {
                 cursorPosition++;
             } else {
                 // Wrap around to top
@@ -356,286 +1028,1990 @@ void ESP32_MenuSystem::moveDown() {
     }
 }
 
-void ESP32_MenuSystem::select() {
-    Menu* currentMenu = getCurrentMenu();
-    if (currentMenu && cursorPosition < currentMenu->itemCount) {
-        MenuItem* selectedItem = &currentMenu->items[cursorPosition];
-        
-        // Check if this is a value adjustment item
-        if (selectedItem->valueAdjuster != nullptr) {
-            // Enter value adjustment mode
-            enterValueAdjustMode(selectedItem->valueAdjuster);
-        } else {
-            // Execute callback if it exists
-            if (selectedItem->callback) {
-                selectedItem->callback->execute();
-            }
-            
-            // Navigate to next menu if specified
-            if (selectedItem->nextMenuId >= 0) {
-                int nextMenuIndex = findMenuById(selectedItem->nextMenuId);
-                if (nextMenuIndex >= 0) {
-                    currentMenuIndex = nextMenuIndex;
-                    cursorPosition = 0; // Reset cursor position for new menu
-                }
-            }
+// Move the current value by a number of increments in one write
+void ESP32_MenuSystem::adjustValueBy(long steps) {
+    if (!currentValueAdjuster || steps == 0) return;
+
+    currentEditor->step(currentValueAdjuster, steps);
+    needsRedraw = true;
+}
+
+// Value and slider: steps are applied to the value at once
+class SliderValueEditor : public ValueEditor {
+public:
+    void step(ValueAdjuster* adjuster, long steps) override {
+        ESP32_MenuSystem::stepAdjuster(adjuster, steps);
+    }
+    void draw(ESP32_MenuSystem& menu, ValueAdjuster* adjuster) override { menu.drawValueAdjust(); }
+};
+
+// Bool: UP / DOWN pick a side, OK applies it
+class ChoiceValueEditor : public ValueEditor {
+public:
+    void begin(ValueAdjuster* adjuster) override {
+        BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(adjuster);
+        boolAdjuster->setTempValue(boolAdjuster->isTrue());
+    }
+    void step(ValueAdjuster* adjuster, long steps) override {
+        static_cast<BoolValueAdjuster*>(adjuster)->setTempValue(steps > 0);
+    }
+    bool accelerates() const override { return false; }
+    void cycle(ValueAdjuster* adjuster, long steps) override {
+        BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(adjuster);
+        boolAdjuster->setTempValue(!boolAdjuster->getTempValue());
+    }
+    bool confirm(ValueAdjuster* adjuster) override {
+        static_cast<BoolValueAdjuster*>(adjuster)->applyTempValue();
+        return true;
+    }
+    void draw(ESP32_MenuSystem& menu, ValueAdjuster* adjuster) override { menu.drawBoolAdjust(); }
+};
+
+// Enum: the option table as a list, one option per step. Options are
+// drawn top-down by index, so UP (positive steps) moves to the option above.
+class ListValueEditor : public ValueEditor {
+public:
+    void step(ValueAdjuster* adjuster, long steps) override {
+        ESP32_MenuSystem::stepAdjuster(adjuster, -steps);
+    }
+    bool accelerates() const override { return false; }
+    void draw(ESP32_MenuSystem& menu, ValueAdjuster* adjuster) override { menu.drawOptionList(); }
+};
+
+static SliderValueEditor sliderEditor;
+static ChoiceValueEditor choiceEditor;
+static ListValueEditor listEditor;
+
+ValueEditor* ESP32_MenuSystem::editorFor(ValueAdjuster* adjuster) {
+    switch (adjuster->getKind()) {
+    case ADJUSTER_KIND_BOOL:
+        return &choiceEditor;
+    case ADJUSTER_KIND_ENUM:
+        return &listEditor;
+    default:
+        return &sliderEditor;
+    }
+}
+
+void ESP32_MenuSystem::stepAdjuster(ValueAdjuster* adjuster, long steps) {
+    switch (adjuster->kind) {
+    case ADJUSTER_KIND_FLOAT: {
+        float* value = static_cast<float*>(adjuster->target);
+        *value = ValueAdjuster::limit(*value + adjuster->range.f.step * steps,
+                                      adjuster->range.f.min, adjuster->range.f.max, adjuster->wrap);
+        break;
+    }
+    case ADJUSTER_KIND_INT:
+    case ADJUSTER_KIND_ENUM: {
+        // 64-bit so large accelerated steps cannot overflow before limiting
+        int* value = static_cast<int*>(adjuster->target);
+        int64_t stepped = (int64_t)*value + (int64_t)adjuster->range.i.step * steps;
+        *value = (int)ValueAdjuster::limit<int64_t>(stepped, adjuster->range.i.min,
+                                                    adjuster->range.i.max, adjuster->wrap);
+        break;
+    }
+    case ADJUSTER_KIND_FIXED: {
+        int32_t* value = static_cast<int32_t*>(adjuster->target);
+        int64_t stepped = (int64_t)*value + (int64_t)adjuster->range.i.step * steps;
+        *value = (int32_t)ValueAdjuster::limit<int64_t>(stepped, adjuster->range.i.min,
+                                                        adjuster->range.i.max, adjuster->wrap);
+        break;
+    }
+    case ADJUSTER_KIND_BOOL:
+        static_cast<BoolValueAdjuster*>(adjuster)->setTempValue(steps > 0);
+        return;
+    default:
+        adjuster->setValue(adjuster->getValue() + adjuster->getIncrement() * steps);
+        return;
+    }
+    adjuster->markChanged();
+}
+
+// Cheap identity of the current value, used to skip re-formatting rows
+uint32_t ESP32_MenuSystem::adjusterValueKey(ValueAdjuster* adjuster) {
+    uint32_t key;
+    float value;
+    switch (adjuster->kind) {
+    case ADJUSTER_KIND_FLOAT:
+        value = *static_cast<float*>(adjuster->target);
+        break;
+    case ADJUSTER_KIND_INT:
+    case ADJUSTER_KIND_ENUM:
+        return (uint32_t)*static_cast<int*>(adjuster->target);
+    case ADJUSTER_KIND_FIXED:
+        return (uint32_t)*static_cast<int32_t*>(adjuster->target);
+    case ADJUSTER_KIND_BOOL:
+        return *static_cast<bool*>(adjuster->target);
+    default:
+        value = adjuster->getValue();
+        break;
+    }
+    memcpy(&key, &value, sizeof(key));
+    return key;
+}
+
+uint8_t ESP32_MenuSystem::formatAdjuster(ValueAdjuster* adjuster, char* buffer, size_t size,
+                                         AdjusterPart part, bool withUnit) {
+    uint8_t length;
+    switch (adjuster->kind) {
+    case ADJUSTER_KIND_FLOAT: {
+        float value = (part == ADJUSTER_PART_MIN) ? adjuster->range.f.min :
+                      (part == ADJUSTER_PART_MAX) ? adjuster->range.f.max :
+                      *static_cast<float*>(adjuster->target);
+        length = formatValue(buffer, size, value, adjuster->decimals);
+        break;
+    }
+    case ADJUSTER_KIND_INT: {
+        int32_t value = (part == ADJUSTER_PART_MIN) ? adjuster->range.i.min :
+                        (part == ADJUSTER_PART_MAX) ? adjuster->range.i.max :
+                        *static_cast<int*>(adjuster->target);
+        length = formatFixed(buffer, size, value, 0);
+        break;
+    }
+    case ADJUSTER_KIND_FIXED: {
+        int32_t value = (part == ADJUSTER_PART_MIN) ? adjuster->range.i.min :
+                        (part == ADJUSTER_PART_MAX) ? adjuster->range.i.max :
+                        *static_cast<int32_t*>(adjuster->target);
+        length = formatFixed(buffer, size, value, adjuster->decimals);
+        break;
+    }
+    case ADJUSTER_KIND_BOOL:
+    case ADJUSTER_KIND_ENUM: {
+        // Labels instead of numbers
+        const char* label;
+        if (adjuster->kind == ADJUSTER_KIND_BOOL) {
+            BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(adjuster);
+            label = (part == ADJUSTER_PART_MIN) ? boolAdjuster->getFalseLabel() :
+                    (part == ADJUSTER_PART_MAX) ? boolAdjuster->getTrueLabel() :
+                    boolAdjuster->getCurrentLabel();
+        } else {
+            EnumValueAdjuster* enumAdjuster = static_cast<EnumValueAdjuster*>(adjuster);
+            label = (part == ADJUSTER_PART_MIN) ? enumAdjuster->getOption(0) :
+                    (part == ADJUSTER_PART_MAX) ? enumAdjuster->getOption(adjuster->range.i.max) :
+                    enumAdjuster->getCurrentOption();
+        }
+        strncpy(buffer, label, size - 1);
+        buffer[size - 1] = '\0';
+        return strlen(buffer);
+    }
+    default: {
+        float value = (part == ADJUSTER_PART_MIN) ? adjuster->getMin() :
+                      (part == ADJUSTER_PART_MAX) ? adjuster->getMax() :
+                      adjuster->getValue();
+        length = formatValue(buffer, size, value, adjuster->getDecimalPlaces());
+        break;
+    }
+    }
+
+    if (withUnit && length < size - 1) {
+        strncpy(buffer + length, adjusterUnit(adjuster), size - length - 1);
+        buffer[size - 1] = '\0';
+        length = strlen(buffer);
+    }
+    return length;
+}
+
+const char* ESP32_MenuSystem::adjusterUnit(ValueAdjuster* adjuster) {
+    return (adjuster->kind == ADJUSTER_KIND_CUSTOM) ? adjuster->getUnit() : adjuster->unit;
+}
+
+// Slider marker offset (0..width) of the value within its range
+int16_t ESP32_MenuSystem::adjusterMarker(ValueAdjuster* adjuster, int16_t width) {
+    switch (adjuster->kind) {
+    case ADJUSTER_KIND_INT:
+    case ADJUSTER_KIND_ENUM:
+    case ADJUSTER_KIND_FIXED:
+    case ADJUSTER_KIND_BOOL: {
+        int32_t value = (adjuster->kind == ADJUSTER_KIND_BOOL) ? *static_cast<bool*>(adjuster->target) :
+                        (adjuster->kind == ADJUSTER_KIND_FIXED) ? *static_cast<int32_t*>(adjuster->target) :
+                        *static_cast<int*>(adjuster->target);
+        int64_t span = (int64_t)adjuster->range.i.max - adjuster->range.i.min;
+        if (span <= 0) return 0;
+        return (int16_t)(((int64_t)width * (value - adjuster->range.i.min)) / span);
+    }
+    default: {
+        bool custom = (adjuster->kind == ADJUSTER_KIND_CUSTOM);
+        float value = custom ? adjuster->getValue() : *static_cast<float*>(adjuster->target);
+        float min = custom ? adjuster->getMin() : adjuster->range.f.min;
+        float max = custom ? adjuster->getMax() : adjuster->range.f.max;
+        if (max <= min) return 0;
+        return (int16_t)(width * (value - min) / (max - min));
+    }
+    }
+}
+
+void ESP32_MenuSystem::select() {
+    needsRedraw = true;
+
+    Menu* currentMenu = getCurrentMenu();
+    if (currentMenu && currentMenu->dataSource) {
+        // The data source decides what an entry does
+        if (cursorPosition < currentMenu->dataSource->count()) {
+            int nextMenuIndex = findMenuById(currentMenu->dataSource->select(cursorPosition));
+            if (nextMenuIndex >= 0) {
+                enterMenu(nextMenuIndex);
+            }
+        }
+    } else if (currentMenu && cursorPosition < currentMenu->itemCount) {
+        const MenuItem* selectedItem = &currentMenu->items[cursorPosition];
+        
+        // Check if this is a value adjustment item
+        if (selectedItem->valueAdjuster != nullptr) {
+            // Enter value adjustment mode
+            enterValueAdjustMode(selectedItem->valueAdjuster, selectedItem->editor);
+        } else {
+            // Run the item's action if it has one
+            selectedItem->execute();
+            
+            // Navigate to next menu if specified
+            if (selectedItem->nextMenuId >= 0) {
+                int nextMenuIndex = findMenuById(selectedItem->nextMenuId);
+                if (nextMenuIndex >= 0) {
+                    enterMenu(nextMenuIndex);
+                }
+            }
+        }
+    }
+}
+
+// Open a menu with the cursor at the top, remembering the current view
+void ESP32_MenuSystem::enterMenu(int menuIndex) {
+    needsRedraw = true;
+
+    // Going to a menu already in the history (a "Back" item pointing at
+    // the parent) unwinds to it instead of growing the stack
+    for (int level = navigationDepth - 1; level >= 0; level--) {
+        if (navigationStack[level].menuIndex == menuIndex) {
+            navigationDepth = level + 1;
+            goBack();
+            return;
+        }
+    }
+
+    if (menuIndex != currentMenuIndex) {
+        if (navigationDepth == MAX_MENU_DEPTH) {
+            // Full: forget the oldest level
+            memmove(&navigationStack[0], &navigationStack[1], (MAX_MENU_DEPTH - 1) * sizeof(NavigationEntry));
+            navigationDepth--;
         }
+        NavigationEntry& entry = navigationStack[navigationDepth++];
+        entry.menuIndex = currentMenuIndex;
+        entry.cursorPosition = cursorPosition;
+        entry.scrollOffset = scrollOffset;
     }
+
+    currentMenuIndex = menuIndex;
+    cursorPosition = 0; // Reset cursor position for new menu
+    scrollOffset = 0;
+    listCacheMenu = -1; // Lists are fetched again when shown
 }
 
 void ESP32_MenuSystem::goBack() {
-    if (currentMenuIndex > 0) {
+    if (navigationDepth > 0) {
+        // Restore the previous view exactly
+        const NavigationEntry& entry = navigationStack[--navigationDepth];
+        currentMenuIndex = entry.menuIndex;
+        cursorPosition = entry.cursorPosition;
+        scrollOffset = entry.scrollOffset;
+        listCacheMenu = -1;
+        needsRedraw = true;
+    } else if (currentMenuIndex > 0) {
         currentMenuIndex = 0; // Go back to main menu
         cursorPosition = 0;
+        scrollOffset = 0;
+        listCacheMenu = -1;
+        needsRedraw = true;
     }
 }
 
 void ESP32_MenuSystem::setCurrentMenu(int menuId) {
     int menuIndex = findMenuById(menuId);
     if (menuIndex >= 0) {
-        currentMenuIndex = menuIndex;
-        cursorPosition = 0;
+        enterMenu(menuIndex);
+    }
+}
+
+// Read a button's raw level, honouring its trigger type
+bool ESP32_MenuSystem::readButton(uint8_t id) {
+    if (buttons[id].pin < 0) return false;
+    return (buttons[id].trigger == TRIGGER_LOW) ?
+           (digitalRead(buttons[id].pin) == LOW) :
+           (digitalRead(buttons[id].pin) == HIGH);
+}
+
+// Integrator debounce: the time the raw level has been active is added,
+// the time it has been released subtracted, clamped to [0, debounceDelay].
+// Short bounces cancel out instead of restarting a timer.
+void ESP32_MenuSystem::integrateButton(uint8_t id, unsigned long timestamp) {
+    ButtonInput& button = buttons[id];
+    unsigned long elapsed = timestamp - button.lastSample;
+    button.lastSample = timestamp;
+
+    if (button.lastState) {
+        button.integral = (button.integral + elapsed >= button.debounceDelay) ?
+                          button.debounceDelay : button.integral + elapsed;
+    } else {
+        button.integral = (button.integral <= elapsed) ? 0 : button.integral - elapsed;
+    }
+}
+
+// Record a raw reading for one button
+void ESP32_MenuSystem::sampleButton(uint8_t id, bool active, unsigned long timestamp) {
+    ButtonInput& button = buttons[id];
+
+    if (button.debounceMode == DEBOUNCE_INTEGRATOR) {
+        // Credit the previous level up to this edge first
+        integrateButton(id, timestamp);
+    } else if (active != button.lastState) {
+        // Any change restarts this button's debounce timer
+        button.lastChange = timestamp;
+    }
+    button.lastState = active;
+    // A press that woke the chip but ended before it settled
+    if (!active && !button.state) button.wakePress = false;
+}
+
+// Accept a new debounced state for one button and act on presses
+void ESP32_MenuSystem::settleButton(uint8_t id, unsigned long timestamp) {
+    ButtonInput& button = buttons[id];
+    bool newState = button.state;
+
+    if (button.debounceMode == DEBOUNCE_INTEGRATOR) {
+        integrateButton(id, timestamp);
+        if (button.integral >= button.debounceDelay) {
+            newState = true;
+        } else if (button.integral == 0) {
+            newState = false;
+        }
+    } else if ((timestamp - button.lastChange) > button.debounceDelay) {
+        // Time based: stable for debounceDelay
+        newState = button.lastState;
+    }
+
+    if (newState != button.state) {
+        button.state = newState;
+        if (button.state) {
+            button.pressedAt = timestamp;
+            #ifdef MENU_INPUT_BUTTONS
+            button.nextRepeat = repeatDelay;
+            #endif
+            button.longPressFired = false;
+            // Also set by wakeFromSleep() for a press that woke the chip
+            button.wakePress = wakeFromIdle() || button.wakePress;
+            if (!button.wakePress) onButtonPressed(id);
+        } else if (button.wakePress) {
+            button.wakePress = false;
+            lastActivity = timestamp;
+        } else {
+            lastActivity = timestamp;
+            onButtonReleased(id);
+        }
+    }
+}
+
+// Time based actions of a button that is being held
+void ESP32_MenuSystem::holdButton(uint8_t id, unsigned long timestamp) {
+    if (!buttons[id].state || buttons[id].wakePress) return;
+    // A held button keeps the display awake
+    lastActivity = timestamp;
+
+    #ifdef MENU_INPUT_SINGLE_BUTTON
+    if (activeInput() == INPUT_SINGLE_BUTTON) {
+        // Long press confirms as soon as the threshold is reached
+        ButtonInput& button = buttons[id];
+        if (id == BUTTON_ID_OK && button.state && !button.longPressFired &&
+            timestamp - button.pressedAt >= longPressThreshold) {
+            button.longPressFired = true;
+            onConfirm();
+        }
+        return;
+    }
+    #endif
+
+    #ifdef MENU_INPUT_BUTTONS
+    repeatButton(id, timestamp);
+    #endif
+}
+
+#ifdef MENU_INPUT_BUTTONS
+// Auto-repeat for a held UP/DOWN. The step grows with the hold time
+// (1x, then 10x, then 100x the increment); each tick only marks the
+// screen dirty, so update() draws once however many steps were applied.
+void ESP32_MenuSystem::repeatButton(uint8_t id, unsigned long timestamp) {
+    if (id != BUTTON_ID_UP && id != BUTTON_ID_DOWN) return;
+
+    ButtonInput& button = buttons[id];
+    if (!button.state || repeatDelay == 0) return;
+    if (!isValueAdjustMode && !repeatInNavigation) return;
+
+    unsigned long held = timestamp - button.pressedAt;
+    if (held < button.nextRepeat) return;
+    button.nextRepeat = held + repeatInterval;
+
+    if (isValueAdjustMode && currentValueAdjuster && currentEditor->accelerates()) {
+        long steps = 1;
+        if (held >= repeatRamp100x) {
+            steps = 100;
+        } else if (held >= repeatRamp10x) {
+            steps = 10;
+        }
+        adjustValueBy((id == BUTTON_ID_UP) ? steps : -steps);
+    } else if (id == BUTTON_ID_UP) {
+        moveUp();
+    } else {
+        moveDown();
+    }
+}
+
+void ESP32_MenuSystem::setButtonRepeat(unsigned long delayMs, unsigned long intervalMs, bool inNavigation) {
+    repeatDelay = delayMs;
+    repeatInterval = (intervalMs > 0) ? intervalMs : 1;
+    repeatInNavigation = inNavigation;
+}
+
+void ESP32_MenuSystem::setButtonRepeatRamp(unsigned long tenXAfterMs, unsigned long hundredXAfterMs) {
+    repeatRamp10x = tenXAfterMs;
+    repeatRamp100x = (hundredXAfterMs > tenXAfterMs) ? hundredXAfterMs : tenXAfterMs;
+}
+#endif
+
+void ESP32_MenuSystem::setDebounceDelay(unsigned long delayMs) {
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        buttons[id].debounceDelay = delayMs;
+    }
+}
+
+void ESP32_MenuSystem::setDebounceDelay(ButtonID buttonId, unsigned long delayMs) {
+    if (buttonId >= 0 && buttonId < BUTTON_COUNT) {
+        buttons[buttonId].debounceDelay = delayMs;
+    }
+}
+
+void ESP32_MenuSystem::setDebounceMode(DebounceMode mode) {
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        setDebounceMode((ButtonID)id, mode);
+    }
+}
+
+void ESP32_MenuSystem::setDebounceMode(ButtonID buttonId, DebounceMode mode) {
+    if (buttonId >= 0 && buttonId < BUTTON_COUNT) {
+        ButtonInput& button = buttons[buttonId];
+        button.debounceMode = mode;
+        button.integral = button.state ? button.debounceDelay : 0;
+        button.lastSample = millis();
+    }
+}
+
+// Act on a debounced press
+void ESP32_MenuSystem::onButtonPressed(uint8_t id) {
+    // A single button acts on release (short) or after the hold (long)
+    if (activeInput() == INPUT_SINGLE_BUTTON) return;
+
+    switch (id) {
+    case BUTTON_ID_UP:
+        moveUp();
+        break;
+    case BUTTON_ID_DOWN:
+        moveDown();
+        break;
+    case BUTTON_ID_OK:
+    case BUTTON_ID_ENCODER:
+        onConfirm();
+        break;
+    }
+}
+
+void ESP32_MenuSystem::onButtonReleased(uint8_t id) {
+    #ifdef MENU_INPUT_SINGLE_BUTTON
+    if (activeInput() != INPUT_SINGLE_BUTTON || id != BUTTON_ID_OK) return;
+    if (buttons[id].longPressFired) return;
+
+    // Short press
+    if (errorCode > 0) {
+        clearError();
+    } else if (isValueAdjustMode && currentValueAdjuster) {
+        currentEditor->cycle(currentValueAdjuster, singleShortPressIsUp ? 1 : -1);
+        needsRedraw = true;
+    } else if (singleShortPressIsUp) {
+        moveUp();
+    } else {
+        moveDown();
+    }
+    #endif
+}
+
+// OK / encoder press (or single button long press)
+void ESP32_MenuSystem::onConfirm() {
+    if (errorCode > 0) {
+        clearError();
+    } else if (isValueAdjustMode && currentValueAdjuster) {
+        if (currentEditor->confirm(currentValueAdjuster)) {
+            exitValueAdjustMode();
+        } else {
+            needsRedraw = true;
+        }
+    } else {
+        select();
     }
 }
 
 void ESP32_MenuSystem::checkButtons() {
-    // Only applicable in button mode
-    if (inputMode != INPUT_BUTTONS) return;
-    
-    // Read the current state of buttons based on their individual trigger types
-    bool currentUpState = (buttonUpTriggerType == TRIGGER_LOW) ? 
-                         (digitalRead(buttonUpPin) == LOW) : 
-                         (digitalRead(buttonUpPin) == HIGH);
-                         
-    bool currentDownState = (buttonDownTriggerType == TRIGGER_LOW) ? 
-                           (digitalRead(buttonDownPin) == LOW) : 
-                           (digitalRead(buttonDownPin) == HIGH);
-                           
-    bool currentOkState = (buttonOkTriggerType == TRIGGER_LOW) ? 
-                         (digitalRead(buttonOkPin) == LOW) : 
-                         (digitalRead(buttonOkPin) == HIGH);
+    // Only applicable in button and single button modes
+    if (activeInput() == INPUT_ENCODER) return;
     
     unsigned long currentMillis = millis();
-    
-    // Check UP button
-    if (currentUpState != lastButtonUpState) {
-        lastDebounceTime = currentMillis;
+    for (uint8_t id = BUTTON_ID_UP; id <= BUTTON_ID_OK; id++) {
+        if (buttons[id].pin < 0) continue;
+        sampleButton(id, readButton(id), currentMillis);
+        settleButton(id, currentMillis);
+        holdButton(id, currentMillis);
     }
-    
-    if ((currentMillis - lastDebounceTime) > debounceDelay) {
-        if (currentUpState != buttonUpState) {
-            buttonUpState = currentUpState;
-            if (buttonUpState) {
-                if (isValueAdjustMode && currentValueAdjuster != nullptr) {
-                    // Increase value
-                    float value = currentValueAdjuster->getValue();
-                    float increment = currentValueAdjuster->getIncrement();
-                    currentValueAdjuster->setValue(value + increment);
-                } else {
-                    moveUp();
-                }
-            }
-        }
+}
+
+// GPIO interrupt handler: queue the new level of one button with its time
+void IRAM_ATTR ESP32_MenuSystem::handleButtonInterrupt(void* arg) {
+    ButtonInput* button = static_cast<ButtonInput*>(arg);
+    ESP32_MenuSystem* owner = button->owner;
+
+    // Register read (inline): gpio_get_level() is in flash, and an edge can
+    // arrive while the flash cache is off (e.g. during an NVS commit)
+    bool level = gpio_ll_get_level(&GPIO, button->pin);
+    bool active = (button->trigger == TRIGGER_LOW) ? !level : level;
+
+    uint8_t head = owner->inputQueue->head;
+    uint8_t next = (head + 1) & (MENU_INPUT_QUEUE_SIZE - 1);
+    if (next == owner->inputQueue->tail) {
+        owner->inputQueueOverflows++;   // Full: drop the newest edge
+        return;
     }
-    
-    // Check DOWN button
-    if (currentDownState != lastButtonDownState) {
-        lastDebounceTime = currentMillis;
+
+    InputQueue::Event& event = owner->inputQueue->events[head];
+    event.button = button - owner->buttons;
+    event.active = active;
+    event.timestamp = millis();
+    owner->inputQueue->head = next;        // Publish after the event is written
+}
+
+void ESP32_MenuSystem::enableInterruptInput(bool enable) {
+    if (enable == interruptInput) return;
+    if (enable && inputQueue == nullptr) {
+        inputQueue = static_cast<InputQueue*>(calloc(1, sizeof(InputQueue)));
+        if (inputQueue == nullptr) return;
     }
-    
-    if ((currentMillis - lastDebounceTime) > debounceDelay) {
-        if (currentDownState != buttonDownState) {
-            buttonDownState = currentDownState;
-            if (buttonDownState) {
-                if (isValueAdjustMode && currentValueAdjuster != nullptr) {
-                    // Decrease value
-                    float value = currentValueAdjuster->getValue();
-                    float increment = currentValueAdjuster->getIncrement();
-                    currentValueAdjuster->setValue(value - increment);
-                } else {
-                    moveDown();
-                }
-            }
+
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        if (buttons[id].pin < 0) continue;
+        if (enable) {
+            // Start from the current level so the first edge is not misread
+            buttons[id].lastState = readButton(id);
+            attachInterruptArg(digitalPinToInterrupt(buttons[id].pin),
+                               handleButtonInterrupt, &buttons[id], CHANGE);
+        } else {
+            detachInterrupt(digitalPinToInterrupt(buttons[id].pin));
         }
     }
-    
-    // Check OK button
-    if (currentOkState != lastButtonOkState) {
-        lastDebounceTime = currentMillis;
+
+    if (inputQueue) inputQueue->tail = inputQueue->head;
+    interruptInput = enable;
+}
+
+// Input arrived: returns true if it woke a switched off display and
+// should do nothing else
+bool ESP32_MenuSystem::wakeFromIdle() {
+    lastActivity = millis();
+    if (idleState == IDLE_ACTIVE) return false;
+
+    bool wasOff = (idleState == IDLE_DISPLAY_OFF);
+    setIdleState(IDLE_ACTIVE);
+    return wasOff;
+}
+
+void ESP32_MenuSystem::wake() {
+    wakeFromIdle();
+}
+
+// Move to a deeper idle state once its timeout has passed; only input
+// brings the menu back
+void ESP32_MenuSystem::updateIdleState(unsigned long now) {
+    unsigned long idle = now - lastActivity;
+    IdleState target = IDLE_ACTIVE;
+    if (displayOffAfter > 0 && idle >= displayOffAfter) {
+        target = IDLE_DISPLAY_OFF;
+    } else if (dimAfter > 0 && idle >= dimAfter) {
+        target = IDLE_DIMMED;
     }
-    
-    if ((currentMillis - lastDebounceTime) > debounceDelay) {
-        if (currentOkState != buttonOkState) {
-            buttonOkState = currentOkState;
-            if (buttonOkState) {
-                if (errorCode > 0) {
-                    clearError();
-                } else if (isValueAdjustMode && currentValueAdjuster) {
-                    // Check for boolean adjuster
-                    if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-                        BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(currentValueAdjuster);
-                        // Apply the temporary selection to the actual value
-                        boolAdjuster->applyTempValue();
-                    }
-                    exitValueAdjustMode();
-                } else {
-                    select();
-                }
-            }
+
+    if (target > idleState) {
+        setIdleState(target);
+    }
+}
+
+void ESP32_MenuSystem::setIdleState(IdleState state) {
+    if (state == idleState) return;
+    if (idleState == IDLE_DISPLAY_OFF) {
+        // Nothing was drawn while the panel was off
+        invalidate();
+    }
+    idleState = state;
+    updatePanelState();
+}
+
+// Send contrast and power save for the idle state. The render task owns
+// the display bus while it runs, so it sends them on its next pass.
+void ESP32_MenuSystem::updatePanelState() {
+    panelUpdatePending = true;
+    if (renderTaskHandle && !inRenderTask()) {
+        xTaskNotifyGive(renderTaskHandle);
+    } else {
+        applyPanelState();
+    }
+}
+
+void ESP32_MenuSystem::applyPanelState() {
+    panelUpdatePending = false;
+    display->setContrast(idleState == IDLE_ACTIVE ? activeContrast : dimContrast);
+    display->setPowerSave(idleState == IDLE_DISPLAY_OFF ? 1 : 0);
+}
+
+void ESP32_MenuSystem::setIdleTimeouts(unsigned long dimAfterMs, unsigned long displayOffAfterMs) {
+    dimAfter = dimAfterMs;
+    displayOffAfter = displayOffAfterMs;
+    lastActivity = millis();
+}
+
+void ESP32_MenuSystem::setIdleContrast(uint8_t active, uint8_t dimmed) {
+    activeContrast = active;
+    dimContrast = dimmed;
+    updatePanelState();
+}
+
+void ESP32_MenuSystem::setIdlePollInterval(unsigned long intervalMs) {
+    idlePollInterval = intervalMs;
+}
+
+// Light sleep with GPIO wakeup on the pins of the active input. Buttons
+// wake on their active level; the encoder wakes when its A channel leaves
+// the level it rests at.
+bool ESP32_MenuSystem::lightSleep(uint64_t timeoutUs) {
+    // Level wakeup replaces a pin's interrupt type, and a level interrupt
+    // would fire until the pin changes. Each pin's handler is switched off
+    // for the sleep and its usual type restored after: any edge for our
+    // button interrupts and the interrupt encoder, none when polled.
+    int wakePins[BUTTON_COUNT + 1];
+    gpio_int_type_t wakePinIntrTypes[BUTTON_COUNT + 1];
+    uint8_t wakePinCount = 0;
+
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        if (buttons[id].pin < 0) continue;
+        gpio_num_t pin = (gpio_num_t)buttons[id].pin;
+        wakePinIntrTypes[wakePinCount] = interruptInput ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE;
+        wakePins[wakePinCount++] = buttons[id].pin;
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, buttons[id].trigger == TRIGGER_LOW ?
+                                GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+
+    #ifdef MENU_INPUT_ENCODER
+    if (activeInput() == INPUT_ENCODER && encoder && encoder->pinA >= 0) {
+        gpio_num_t pin = (gpio_num_t)encoder->pinA;
+        #ifdef USE_ESP32_ENCODER
+        wakePinIntrTypes[wakePinCount] = GPIO_INTR_DISABLE;   // Counted by the PCNT unit
+        #else
+        wakePinIntrTypes[wakePinCount] = GPIO_INTR_ANYEDGE;
+        #endif
+        wakePins[wakePinCount++] = encoder->pinA;
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, gpio_get_level(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    #endif
+
+    if (wakePinCount == 0) return false;
+
+    esp_sleep_enable_gpio_wakeup();
+    if (timeoutUs > 0) {
+        esp_sleep_enable_timer_wakeup(timeoutUs);
+    }
+    esp_light_sleep_start();
+
+    for (uint8_t i = 0; i < wakePinCount; i++) {
+        gpio_num_t pin = (gpio_num_t)wakePins[i];
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, wakePinIntrTypes[i]);
+        if (wakePinIntrTypes[i] != GPIO_INTR_DISABLE) {
+            gpio_intr_enable(pin);
         }
     }
-    
-    lastButtonUpState = currentUpState;
-    lastButtonDownState = currentDownState;
-    lastButtonOkState = currentOkState;
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    if (timeoutUs > 0) {
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    }
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        wakeFromSleep();
+    }
+    return true;
 }
 
-// Update the handleEncoderMovement method in ESP32_MenuSystem.cpp
-void ESP32_MenuSystem::handleEncoderMovement() {
-    // Only applicable in encoder mode
-    if (inputMode != INPUT_ENCODER || encoder == nullptr) return;
-    
-    long currentEncoderValue;
-    
-    #ifdef USE_ESP32_ENCODER
-        currentEncoderValue = encoder->getCount();
-    #else
-        currentEncoderValue = encoder->read();
+// A menu pin woke the chip. The input may be over before it is read, so
+// the display wakes here; presses still held are kept from acting, as is
+// the encoder movement so far.
+void ESP32_MenuSystem::wakeFromSleep() {
+    lockState();
+    unsigned long now = millis();
+    wakeFromIdle();
+
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        if (buttons[id].pin < 0) continue;
+        bool active = readButton(id);
+        if (active && !buttons[id].state) buttons[id].wakePress = true;
+        // Edges during the sleep were not queued
+        if (interruptInput) sampleButton(id, active, now);
+    }
+
+    #ifdef MENU_INPUT_ENCODER
+    if (activeInput() == INPUT_ENCODER) {
+        resyncEncoder();
+    }
     #endif
-    
-    if (currentEncoderValue != lastEncoderValue) {
-        // Determine direction (UP or DOWN)
-        int8_t encoderDir = (currentEncoderValue > lastEncoderValue) ? 1 : -1;
-        
-        // Add to accumulator
-        encoderAccumulator += encoderDir;
-        
-        // Only process if accumulator exceeds sensitivity threshold
-        if (abs(encoderAccumulator) >= encoderSensitivity) {
-            // Determine the direction based on accumulator
-            int8_t movementDir = (encoderAccumulator > 0) ? 1 : -1;
-            
-            if (isValueAdjustMode && currentValueAdjuster != nullptr) {
-                // Special handling for boolean adjusters
-                if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-                    BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(currentValueAdjuster);
-                    
-                    // Change the temp selection based on direction
-                    // Clockwise (positive) = true, Counter-clockwise (negative) = false
-                    boolAdjuster->setTempValue(movementDir > 0);
-                } else {
-                    // For non-boolean adjusters, use the original value adjustment
-                    float currentValue = currentValueAdjuster->getValue();
-                    float increment = currentValueAdjuster->getIncrement();
-                    
-                    // Apply increment based on direction
-                    float newValue = currentValue + (increment * movementDir);
-                    
-                    // Apply limits and set value
-                    currentValueAdjuster->setValue(newValue);
-                }
-            } else {
-                // Regular menu navigation
-                if (movementDir > 0) {
-                    // Move cursor down
-                    moveDown();
-                } else {
-                    // Move cursor up
-                    moveUp();
-                }
-            }
-            
-            // Reset accumulator (keep the remainder for smoother sensitivity)
-            encoderAccumulator = encoderAccumulator % encoderSensitivity;
+    unlockState();
+}
+
+// Handle input for whichever backend is active; with a single backend
+// compiled in, the mode checks are constant and fold away
+void ESP32_MenuSystem::pollInput() {
+    #ifdef MENU_INPUT_ENCODER
+    if (activeInput() == INPUT_ENCODER) {
+        handleEncoderMovement();
+        if (!interruptInput) {
+            handleButtonPress();
         }
-        
-        // Update last value
-        lastEncoderValue = currentEncoderValue;
     }
+    #endif
+
+    if (interruptInput) {
+        // Button edges were queued by the GPIO interrupt
+        processInputQueue();
+    } else if (activeInput() != INPUT_ENCODER) {
+        checkButtons();
+    }
+
+    #ifdef MENU_INPUT_REMOTE
+    if (remote && remote->stream) {
+        Print* reply = remote->replies ? remote->stream : nullptr;
+        while (remote->stream->available() > 0) {
+            int c = remote->stream->read();
+            if (c < 0) break;
+            feedRemote((uint8_t)c, reply);
+        }
+    }
+    #endif
+}
+
+#ifdef MENU_INPUT_REMOTE
+static int16_t readLE16(const uint8_t* p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t* writeLE16(uint8_t* p, int16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)((uint16_t)value >> 8);
+    return p + 2;
+}
+
+static uint8_t* writeLE32(uint8_t* p, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+    return p + 4;
+}
+
+// Argument bytes after each command byte, -1 for unknown commands
+static int remoteArgumentSize(uint8_t command) {
+    switch (command) {
+        case REMOTE_UP:
+        case REMOTE_DOWN:
+        case REMOTE_SELECT:
+        case REMOTE_BACK:
+        case REMOTE_GET_STATE:
+            return 0;
+        case REMOTE_OPEN_MENU:
+            return 2;
+        case REMOTE_GET_VALUE:
+            return 4;
+        case REMOTE_SET_VALUE:
+            return 8;
+        default:
+            return -1;
+    }
+}
+
+// Remote state is allocated by the first setRemoteControl() or datagram
+ESP32_MenuSystem::RemoteState* ESP32_MenuSystem::remoteState() {
+    if (remote == nullptr) {
+        remote = static_cast<RemoteState*>(calloc(1, sizeof(RemoteState)));
+        if (remote == nullptr) return nullptr;
+        remote->replies = true;
+        remote->rxState = RemoteState::RX_SYNC;
+        remote->sentMenu = INT16_MIN;
+    }
+    return remote;
+}
+
+void ESP32_MenuSystem::setRemoteControl(Stream* stream, bool replies) {
+    lockState();
+    if (remoteState() == nullptr) {
+        unlockState();
+        return;
+    }
+    remote->stream = stream;
+    remote->replies = replies;
+    remote->rxState = RemoteState::RX_SYNC;
+    remote->sentMenu = INT16_MIN;
+    unlockState();
+}
+
+void ESP32_MenuSystem::handleRemoteData(const uint8_t* data, size_t length, Print* reply) {
+    lockState();
+    if (remoteState() == nullptr) length = 0;
+    for (size_t i = 0; i < length; i++) {
+        feedRemote(data[i], reply);
+    }
+    unlockState();
+}
+
+// Collect one frame byte by byte; bad frames are answered with an error
+void ESP32_MenuSystem::feedRemote(uint8_t byte, Print* reply) {
+    switch (remote->rxState) {
+    case RemoteState::RX_SYNC:
+        if (byte == REMOTE_SYNC) remote->rxState = RemoteState::RX_LENGTH;
+        break;
+    case RemoteState::RX_LENGTH:
+        if (byte > MENU_REMOTE_FRAME_SIZE) {
+            // Too long to hold: wait for the next frame
+            remote->rxState = RemoteState::RX_SYNC;
+            break;
+        }
+        remote->rxLength = byte;
+        remote->rxCount = 0;
+        remote->rxCheck = 0;
+        remote->rxState = (byte > 0) ? RemoteState::RX_PAYLOAD : RemoteState::RX_CHECK;
+        break;
+    case RemoteState::RX_PAYLOAD:
+        remote->rx[remote->rxCount++] = byte;
+        remote->rxCheck ^= byte;
+        if (remote->rxCount == remote->rxLength) remote->rxState = RemoteState::RX_CHECK;
+        break;
+    case RemoteState::RX_CHECK:
+        remote->rxState = RemoteState::RX_SYNC;
+        if (byte == remote->rxCheck) {
+            applyRemoteFrame(remote->rx, remote->rxLength, reply);
+        } else if (reply) {
+            const uint8_t error[2] = { REMOTE_ERROR, 0xFF };
+            sendRemoteFrame(reply, error, sizeof(error));
+        }
+        break;
+    }
+}
+
+// Apply a batch of commands. They only change the menu state, so the
+// whole batch is drawn in one frame on the next displayMenu().
+void ESP32_MenuSystem::applyRemoteFrame(const uint8_t* payload, uint8_t length, Print* reply) {
+    wakeFromIdle();
+    remote->valueCount = 0;
+
+    uint8_t out[MENU_REMOTE_FRAME_SIZE];
+    uint8_t outLength = 0;
+    uint8_t offset = 0;
+    while (offset < length) {
+        uint8_t command = payload[offset];
+        int size = remoteArgumentSize(command);
+        bool complete = size >= 0 && offset + 1 + size <= length;
+        if ((!complete || !applyRemoteCommand(payload + offset + 1, command)) &&
+            outLength + 2 <= MENU_REMOTE_FRAME_SIZE) {
+            out[outLength++] = REMOTE_ERROR;
+            out[outLength++] = offset;
+        }
+        // Without its size the next command cannot be found
+        if (!complete) break;
+        offset += 1 + size;
+    }
+
+    if (!reply) return;
+
+    // State delta: menu, cursor and mode if any of them changed, then the
+    // values the batch set, read or adjusted
+    int16_t menuId = (int16_t)getCurrentMenuId();
+    int16_t cursor = (int16_t)cursorPosition;
+    uint8_t mode = (errorCode > 0) ? REMOTE_MODE_ERROR :
+                   isValueAdjustMode ? REMOTE_MODE_ADJUSTING : REMOTE_MODE_MENU;
+    if ((menuId != remote->sentMenu || cursor != remote->sentCursor || mode != remote->sentMode) &&
+        outLength + 6 <= MENU_REMOTE_FRAME_SIZE) {
+        uint8_t* p = out + outLength;
+        *p++ = REMOTE_STATE;
+        p = writeLE16(p, menuId);
+        p = writeLE16(p, cursor);
+        *p++ = mode;
+        outLength = p - out;
+        remote->sentMenu = menuId;
+        remote->sentCursor = cursor;
+        remote->sentMode = mode;
+    }
+
+    for (uint8_t i = 0; i < remote->valueCount && outLength + 9 <= MENU_REMOTE_FRAME_SIZE; i++) {
+        const Menu& menu = model->menus[remote->values[i].menuIndex];
+        uint8_t* p = out + outLength;
+        *p++ = REMOTE_VALUE;
+        p = writeLE16(p, (int16_t)menu.id);
+        p = writeLE16(p, (int16_t)remote->values[i].item);
+        p = writeLE32(p, valueBits(menu.items[remote->values[i].item].valueAdjuster));
+        outLength = p - out;
+    }
+
+    sendRemoteFrame(reply, out, outLength);
+}
+
+// One command with its arguments; false if it refers to nothing
+bool ESP32_MenuSystem::applyRemoteCommand(const uint8_t* args, uint8_t command) {
+    // Steps and confirms while adjusting change the adjusted value
+    bool adjusting = isValueAdjustMode && currentValueAdjuster;
+    int16_t menuIndex;
+    const MenuItem* item;
+
+    switch (command) {
+    case REMOTE_UP:
+    case REMOTE_DOWN:
+    case REMOTE_SELECT:
+        if (adjusting) addRemoteValue(currentMenuIndex, cursorPosition);
+        if (command == REMOTE_UP) {
+            moveUp();
+        } else if (command == REMOTE_DOWN) {
+            moveDown();
+        } else {
+            onConfirm();
+        }
+        return true;
+    case REMOTE_BACK:
+        if (errorCode > 0) {
+            clearError();
+        } else if (adjusting) {
+            exitValueAdjustMode();
+        } else {
+            goBack();
+        }
+        return true;
+    case REMOTE_OPEN_MENU:
+        if (findMenuById(readLE16(args)) < 0) return false;
+        if (isValueAdjustMode) exitValueAdjustMode();
+        setCurrentMenu(readLE16(args));
+        return true;
+    case REMOTE_SET_VALUE:
+        item = remoteItem(readLE16(args), (uint16_t)readLE16(args + 2), &menuIndex);
+        if (!item || !item->valueAdjuster) return false;
+        applyValueBits(item->valueAdjuster, readLE32(args + 4));
+        if (item->valueAdjuster == currentValueAdjuster) {
+            currentEditor->begin(currentValueAdjuster);
+        }
+        needsRedraw = true;
+        addRemoteValue(menuIndex, (uint16_t)readLE16(args + 2));
+        return true;
+    case REMOTE_GET_VALUE:
+        item = remoteItem(readLE16(args), (uint16_t)readLE16(args + 2), &menuIndex);
+        if (!item || !item->valueAdjuster) return false;
+        addRemoteValue(menuIndex, (uint16_t)readLE16(args + 2));
+        return true;
+    case REMOTE_GET_STATE:
+        // Report the state even if it did not change
+        remote->sentMenu = INT16_MIN;
+        return true;
+    }
+    return false;
+}
+
+const MenuItem* ESP32_MenuSystem::remoteItem(int menuId, uint16_t item, int16_t* menuIndex) {
+    int index = findMenuById(menuId);
+    if (index < 0) return nullptr;
+    const Menu& menu = model->menus[index];
+    if (menu.dataSource || item >= menu.itemCount) return nullptr;
+    *menuIndex = (int16_t)index;
+    return &menu.items[item];
+}
+
+// Items past UINT16_MAX cannot be addressed by the protocol and are skipped
+void ESP32_MenuSystem::addRemoteValue(int16_t menuIndex, int item) {
+    const Menu& menu = model->menus[menuIndex];
+    if (menu.dataSource || item < 0 || item > UINT16_MAX || item >= menu.itemCount) return;
+    if (!menu.items[item].valueAdjuster) return;
+    for (uint8_t i = 0; i < remote->valueCount; i++) {
+        if (remote->values[i].menuIndex == menuIndex && remote->values[i].item == item) return;
+    }
+    if (remote->valueCount < MENU_REMOTE_MAX_VALUES) {
+        remote->values[remote->valueCount].menuIndex = menuIndex;
+        remote->values[remote->valueCount].item = item;
+        remote->valueCount++;
+    }
+}
+
+void ESP32_MenuSystem::sendRemoteFrame(Print* out, const uint8_t* payload, uint8_t length) {
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        check ^= payload[i];
+    }
+    const uint8_t header[2] = { REMOTE_SYNC, length };
+    out->write(header, sizeof(header));
+    out->write(payload, length);
+    out->write(check);
+}
+#endif // MENU_INPUT_REMOTE
+
+// Replay queued edges in order, then let any stable state settle. A press
+// is not lost even if update() runs long after the button was released.
+void ESP32_MenuSystem::processInputQueue() {
+    while (inputQueue->tail != inputQueue->head) {
+        const InputQueue::Event& event = inputQueue->events[inputQueue->tail];
+
+        #ifdef MENU_ENABLE_STATS
+        if (!inputDrained) {
+            inputDrained = true;
+            oldestInputMillis = event.timestamp;
+        }
+        #endif
+
+        // Whatever the state was before this edge may have settled already
+        settleButton(event.button, event.timestamp);
+        sampleButton(event.button, event.active, event.timestamp);
+
+        inputQueue->tail = (inputQueue->tail + 1) & (MENU_INPUT_QUEUE_SIZE - 1);
+    }
+
+    unsigned long currentMillis = millis();
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        if (buttons[id].pin >= 0) {
+            settleButton(id, currentMillis);
+            holdButton(id, currentMillis);
+        }
+    }
+}
+
+#ifdef MENU_INPUT_ENCODER
+// Update the handleEncoderMovement method in ESP32_MenuSystem.cpp
+void ESP32_MenuSystem::handleEncoderMovement() {
+    // Only applicable in encoder mode
+    if (activeInput() != INPUT_ENCODER || encoder == nullptr) return;
+    
+    long currentEncoderValue;
+    
+    #ifdef USE_ESP32_ENCODER
+        currentEncoderValue = encoder->device->getCount();
+    #else
+        currentEncoderValue = encoder->device->read();
+    #endif
+    
+    if (currentEncoderValue == encoder->lastValue) return;
+
+    // Consume the whole delta so fast spins don't lose ticks
+    encoder->accumulator += currentEncoderValue - encoder->lastValue;
+    encoder->lastValue = currentEncoderValue;
+
+    // Whole movements at the configured sensitivity (keep the remainder)
+    long steps = encoder->accumulator / encoder->sensitivity;
+    if (steps == 0) return;
+    encoder->accumulator -= steps * encoder->sensitivity;
+
+    unsigned long currentMillis = millis();
+    unsigned long elapsed = currentMillis - encoder->lastStepTime;
+    encoder->lastStepTime = currentMillis;
+
+    // Movement that wakes the display does nothing else
+    if (wakeFromIdle()) return;
+            
+    if (isValueAdjustMode && currentValueAdjuster != nullptr) {
+        // Faster turning applies larger steps, in a single write
+        adjustValueBy(currentEditor->accelerates() ? steps * encoderAccelerationFor(steps, elapsed) : steps);
+    } else {
+        // Regular menu navigation, one row per movement
+        for (long i = 0; i < labs(steps); i++) {
+            if (steps > 0) {
+                // Move cursor down
+                moveDown();
+            } else {
+                // Move cursor up
+                moveUp();
+            }
+        }
+    }
+}
+
+// Multiplier for a burst of encoder steps, from the turning rate
+uint16_t ESP32_MenuSystem::encoderAccelerationFor(long steps, unsigned long elapsedMs) {
+    if (elapsedMs == 0) elapsedMs = 1;
+    unsigned long rate = (unsigned long)labs(steps) * 1000UL / elapsedMs;  // Steps per second
+
+    uint16_t multiplier = 1;
+    for (uint8_t i = 0; i < encoder->accelerationCount; i++) {
+        if (rate >= encoder->acceleration[i].minRate) {
+            multiplier = encoder->acceleration[i].multiplier;
+        }
+    }
+    return multiplier;
+}
+
+void ESP32_MenuSystem::setEncoderAcceleration(const EncoderAccelerationStep* steps, uint8_t count) {
+    if (encoder == nullptr) return;
+    if (steps == nullptr) count = 0;
+    if (count > MAX_ENCODER_ACCEL_STEPS) count = MAX_ENCODER_ACCEL_STEPS;
+    for (uint8_t i = 0; i < count; i++) {
+        encoder->acceleration[i] = steps[i];
+    }
+    encoder->accelerationCount = count;
+}
+
+void ESP32_MenuSystem::handleButtonPress() {
+    // Only applicable in encoder mode
+    if (activeInput() != INPUT_ENCODER) return;
+    
+    unsigned long currentMillis = millis();
+    sampleButton(BUTTON_ID_ENCODER, readButton(BUTTON_ID_ENCODER), currentMillis);
+    settleButton(BUTTON_ID_ENCODER, currentMillis);
+}
+
+// Forget movement made while the picture changed, so it cannot jump
+void ESP32_MenuSystem::resyncEncoder() {
+    if (encoder == nullptr) return;
+
+    #ifdef USE_ESP32_ENCODER
+        encoder->lastValue = encoder->device->getCount();
+    #else
+        encoder->lastValue = encoder->device->read();
+    #endif
+    encoder->accumulator = 0;
+}
+#endif // MENU_INPUT_ENCODER
+
+void ESP32_MenuSystem::enterValueAdjustMode(ValueAdjuster* adjuster, ValueEditor* editor) {
+    if (!adjuster) return;
+    isValueAdjustMode = true;
+    needsRedraw = true;
+    currentValueAdjuster = adjuster;
+
+    // Every input event and frame goes to this editor until adjustment ends
+    currentEditor = editor ? editor : editorFor(adjuster);
+    currentEditor->begin(adjuster);
+    
+    #ifdef MENU_INPUT_ENCODER
+    // If using encoder, reset count to prevent sudden jumps
+    if (activeInput() == INPUT_ENCODER) {
+        resyncEncoder();
+    }
+    #endif
+}
+
+// Revisions of the adjusters on screen (the one being edited, or the
+// rows around the view) or of the persisted ones, mixed into one key
+uint32_t ESP32_MenuSystem::adjusterRevisionKey(bool persistedOnly) {
+    uint32_t key = 0;
+    if (persistedOnly) {
+        if (persist == nullptr) return key;
+        for (uint8_t i = 0; i < persist->count; i++) {
+            key = hashMix(key, persist->values[i].adjuster->revision);
+        }
+        return key;
+    }
+
+    if (isValueAdjustMode) {
+        return currentValueAdjuster ? hashMix(key, currentValueAdjuster->revision) : key;
+    }
+
+    Menu* currentMenu = getCurrentMenu();
+    if (!currentMenu || currentMenu->dataSource || !currentMenu->items) return key;
+
+    // A row more on each side covers rows scrolling in or out
+    int first = scrollOffset - 1;
+    int last = scrollOffset + menuItemsVisible + 1;
+    if (first < 0) first = 0;
+    if (last > currentMenu->itemCount) last = currentMenu->itemCount;
+    for (int i = first; i < last; i++) {
+        ValueAdjuster* adjuster = currentMenu->items[i].valueAdjuster;
+        if (adjuster) key = hashMix(hashMix(key, i), adjuster->revision);
+    }
+    return key;
+}
+
+void ESP32_MenuSystem::displayMenu() {
+    unsigned long currentMillis = millis();
+
+    // Shown values changed through their adjusters outside our own input
+    uint32_t adjusterKey = adjusterRevisionKey(false);
+    if (adjusterKey != shownAdjusterKey) {
+        shownAdjusterKey = adjusterKey;
+        needsRedraw = true;
+    }
+
+    // Menus changed, possibly through another view of the same tree
+    if (model->revision != modelRevision) {
+        modelRevision = model->revision;
+        needsRedraw = true;
+    }
+
+    // Switched off: the next frame is drawn on wake
+    if (idleState == IDLE_DISPLAY_OFF) return;
+
+    // Dimmed: only redraw for changes
+    bool refreshing = (idleState == IDLE_ACTIVE);
+    if (refreshing && refreshMode == REFRESH_CONTINUOUS) {
+        needsRedraw = true;
+    } else if (refreshing && refreshMode == REFRESH_TIMED && currentMillis - previousMillis >= interval) {
+        // Live data drawn by a screen info callback can change at any time
+        previousMillis = currentMillis;
+        Menu* currentMenu = getCurrentMenu();
+        if (currentMenu && currentMenu->hasScreenInfo && !isValueAdjustMode && errorCode == 0) {
+            needsRedraw = true;
+        }
+    }
+
+    // A running animation asks for its next frame
+    if (animating) needsRedraw = true;
+
+    // Screen info regions that are due are drawn over the last frame.
+    // A page buffer keeps no frame, so it redraws the whole screen.
+    bool regionsDue = !needsRedraw && infoRegionsDue(currentMillis, refreshing);
+    if (regionsDue && pageBufferMode) {
+        needsRedraw = true;
+        regionsDue = false;
+    }
+
+    // The previous frame is still being sent; draw once it is out
+    if (flushActive && (needsRedraw || regionsDue)) return;
+
+    if (!needsRedraw && !regionsDue) {
+        #ifdef MENU_ENABLE_STATS
+        framesSkipped++;
+        #endif
+        return;
+    }
+
+    // Frame rate cap: changes made before the next frame is due are
+    // coalesced into it
+    unsigned long frameBudget = frameInterval;
+    if (frameBudget == 0 && animating) frameBudget = MENU_ANIMATION_FRAME_MS;
+    if (frameBudget > 0 && currentMillis - lastFrameTime < frameBudget) return;
+    lastFrameTime = currentMillis;
+
+    if (renderTaskHandle) {
+        // The render task clears needsRedraw once it has drawn the frame
+        if (regionsDue) regionFramePending = true;
+        xTaskNotifyGive(renderTaskHandle);
+        return;
+    }
+
+    if (regionsDue) {
+        drawRegionFrame();
+        flushFrame();
+        return;
+    }
+    needsRedraw = false;
+
+    renderFrame(&ESP32_MenuSystem::drawScreen, true);
+}
+
+void ESP32_MenuSystem::setRenderMode(RenderMode mode) {
+    renderMode = mode;
+    if (mode == RENDER_AUTO) {
+        // _1/_2 constructors buffer fewer tile rows than the panel has
+        pageBufferMode = display != nullptr &&
+                         display->getBufferTileHeight() < (display->getDisplayHeight() + 7) / 8;
+    } else {
+        pageBufferMode = (mode == RENDER_PAGE_BUFFER);
+    }
+    checkBufferLayout();
+    invalidate();
+}
+
+// Draw two probe pixels and see where they land. U8g2 rotates and mirrors
+// in software, so with anything but U8G2_R0 the bytes of a screen tile
+// are elsewhere in the buffer (U8G2_R2 puts screen tile row 0 last).
+void ESP32_MenuSystem::checkBufferLayout() {
+    bufferLayout = BUFFER_OTHER;
+    if (display == nullptr || pageBufferMode || display->getBufferPtr() == nullptr) return;
+
+    const uint8_t* buffer = display->getBufferPtr();
+    uint16_t tileCols = display->getBufferTileWidth();
+    uint16_t size = tileCols * 8 * display->getBufferTileHeight();
+    static const int16_t probes[2][2] = { { 1, 2 }, { 10, 9 } };
+    bool vertical = true;
+    bool horizontal = true;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        int16_t x = probes[i][0];
+        int16_t y = probes[i][1];
+        display->clearBuffer();
+        display->setDrawColor(1);
+        display->drawPixel(x, y);
+
+        // A plain layout changes exactly one byte
+        uint16_t offset = 0;
+        uint16_t changed = 0;
+        for (uint16_t b = 0; b < size; b++) {
+            if (buffer[b] != 0) {
+                offset = b;
+                changed++;
+            }
+        }
+        if (changed != 1) {
+            vertical = horizontal = false;
+            break;
+        }
+
+        // Vertical: one byte per column of 8 rows; horizontal: one byte per 8 columns
+        vertical = vertical && offset == (y / 8) * tileCols * 8 + x && buffer[offset] == (1 << (y & 7));
+        horizontal = horizontal && offset == y * tileCols + x / 8;
+    }
+    display->clearBuffer();
+
+    if (vertical) bufferLayout = BUFFER_TILES_VERTICAL;
+    else if (horizontal) bufferLayout = BUFFER_TILES_HORIZONTAL;
+}
+
+void ESP32_MenuSystem::setPartialUpdates(bool enable) {
+    partialUpdates = enable;
+    needsFullFlush = true;
+    needsRedraw = true;
+}
+
+void ESP32_MenuSystem::setRefreshMode(RefreshMode mode, unsigned long intervalMs) {
+    refreshMode = mode;
+    interval = intervalMs;
+    needsRedraw = true;
+}
+
+// Clear the buffer, run one draw function and send the frame. With
+// allowPartial only the tiles whose regions changed are sent. In page
+// buffer mode the draw function is replayed once per page instead.
+void ESP32_MenuSystem::renderFrame(DrawFunction draw, bool allowPartial) {
+    if (renderTaskHandle && !inRenderTask()) {
+        // The display belongs to the render task; it draws the current
+        // screen (whichever this was) on its next pass
+        needsRedraw = true;
+        needsFullFlush = true;
+        xTaskNotifyGive(renderTaskHandle);
+        return;
+    }
+
+    if (drawFrame(draw, allowPartial)) {
+        flushFrame();
+    }
+}
+
+// Draw a frame into the buffer. In page buffer mode drawing and sending
+// are interleaved, so the frame is complete when this returns false.
+bool ESP32_MenuSystem::drawFrame(DrawFunction draw, bool allowPartial) {
+    // The buffer is still being sent: finish that before drawing over it
+    finishFlush();
+
+    // One time for the whole frame, so page buffer passes agree
+    frameTime = millis();
+    animating = false;
+
+    #ifdef MENU_ENABLE_STATS
+    uint32_t start = MENU_STATS_CYCLES();
+    framesRendered++;
+    #endif
+
+    frameFullFlush = needsFullFlush || !allowPartial || !canSendPartial();
+    needsFullFlush = false;
+
+    if (pageBufferMode) {
+        frameFullFlush = true;
+        #ifdef MENU_ENABLE_MIRROR
+        mirrorBegin();
+        #endif
+        display->firstPage();
+        do {
+            (this->*draw)();
+            #ifdef MENU_ENABLE_MIRROR
+            // The page stays in the buffer until nextPage() sends it
+            mirrorRows(display->getBufferCurrTileRow(), display->getBufferTileHeight(), true);
+            #endif
+        } while (display->nextPage());
+        #ifdef MENU_ENABLE_MIRROR
+        mirrorEnd();
+        #endif
+
+        #ifdef MENU_ENABLE_STATS
+        addSample(TIMING_DRAW, MENU_STATS_CYCLES() - start);
+        noteFrameSent();
+        #endif
+        return false;
+    }
+
+    for (uint8_t row = 0; row < MAX_DISPLAY_TILE_ROWS; row++) {
+        damageX0[row] = 0xFF;
+        damageX1[row] = 0;
+    }
+
+    display->clearBuffer();
+    (this->*draw)();
+
+    #ifdef MENU_ENABLE_STATS
+    addSample(TIMING_DRAW, MENU_STATS_CYCLES() - start);
+    #endif
+    return true;
+}
+
+void ESP32_MenuSystem::setRenderTask(bool enable, BaseType_t core, UBaseType_t priority, uint32_t stackSize) {
+    renderTaskEnabled = enable;
+    renderTaskCore = core;
+    renderTaskPriority = priority;
+    renderTaskStackSize = stackSize;
+    if (!enable) {
+        stopRenderTask();
+    }
+}
+
+void ESP32_MenuSystem::startRenderTask() {
+    if (!renderTaskEnabled || renderTaskHandle) return;
+
+    if (!stateMutex) {
+        stateMutex = xSemaphoreCreateRecursiveMutex();
+        if (!stateMutex) return;
+    }
+
+    // Draw the first frame
+    needsRedraw = true;
+    needsFullFlush = true;
+
+    // The task cannot run before its handle is published: it waits for
+    // the notification sent below
+    TaskHandle_t task = nullptr;
+    if (xTaskCreatePinnedToCore(renderTaskLoop, "menuRender", renderTaskStackSize, this,
+                                renderTaskPriority, &task, renderTaskCore) != pdPASS) {
+        // Not enough memory: keep rendering from update()
+        return;
+    }
+    renderTaskHandle = task;
+    xTaskNotifyGive(task);
+}
+
+// Ask the task to exit and wait for it, so a transfer on the display bus
+// is never cut off halfway. Must not be called while holding lockState().
+void ESP32_MenuSystem::stopRenderTask() {
+    if (!renderTaskHandle) return;
+
+    renderTaskStopping = true;
+    xTaskNotifyGive(renderTaskHandle);
+    while (renderTaskHandle) {
+        vTaskDelay(1);
+    }
+    renderTaskStopping = false;
+}
+
+void ESP32_MenuSystem::renderTaskLoop(void* arg) {
+    ESP32_MenuSystem* menu = static_cast<ESP32_MenuSystem*>(arg);
+    for (;;) {
+        // Sleep until update() has something to show
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (menu->renderTaskStopping) break;
+        menu->renderPending();
+    }
+
+    menu->renderTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+// Render task: draw under the lock, send the buffer without it
+void ESP32_MenuSystem::renderPending() {
+    if (panelUpdatePending) {
+        applyPanelState();
+    }
+
+    lockState();
+    if (!needsRedraw && !regionFramePending) {
+        unlockState();
+        return;
+    }
+
+    // A full frame draws the regions too
+    bool flushPending = true;
+    if (needsRedraw) {
+        DrawFunction draw = &ESP32_MenuSystem::drawScreen;
+        flushPending = drawFrame(draw, true);
+    } else {
+        drawRegionFrame();
+    }
+    needsRedraw = false;
+    regionFramePending = false;
+    unlockState();
+
+    if (flushPending) {
+        flushFrame();
+    }
+}
+
+bool ESP32_MenuSystem::inRenderTask() const {
+    return renderTaskHandle && xTaskGetCurrentTaskHandle() == renderTaskHandle;
+}
+
+void ESP32_MenuSystem::lockState() {
+    if (stateMutex) {
+        xSemaphoreTakeRecursive(stateMutex, portMAX_DELAY);
+    }
+}
+
+void ESP32_MenuSystem::unlockState() {
+    if (stateMutex) {
+        xSemaphoreGiveRecursive(stateMutex);
+    }
+}
+
+// Full-screen redraws (different screen or menu) cannot be sent partially
+void ESP32_MenuSystem::beginScreen(uint32_t key) {
+    if (key != screenKey) {
+        screenKey = key;
+        frameFullFlush = true;
+    }
+}
+
+// Compare a region's content key with the previous frame and mark its
+// tiles for sending if it changed
+void ESP32_MenuSystem::trackRegion(uint8_t region, uint32_t key, int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (regionKeys[region] == key) return;
+    regionKeys[region] = key;
+    markDamage(x, y, w, h);
+}
+
+// Add a pixel rectangle to the per-tile-row damage spans
+void ESP32_MenuSystem::markDamage(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (frameFullFlush || w <= 0 || h <= 0) return;
+
+    int16_t tileCols = display->getBufferTileWidth();
+    int16_t tileRows = display->getBufferTileHeight();
+    if (tileRows > MAX_DISPLAY_TILE_ROWS) {
+        frameFullFlush = true;
+        return;
+    }
+
+    int16_t tx0 = (x < 0) ? 0 : x / 8;
+    int16_t tx1 = (x + w - 1) / 8;
+    int16_t ty0 = (y < 0) ? 0 : y / 8;
+    int16_t ty1 = (y + h - 1) / 8;
+    if (tx1 >= tileCols) tx1 = tileCols - 1;
+    if (ty1 >= tileRows) ty1 = tileRows - 1;
+    if (tx0 > tx1 || ty0 > ty1) return;
+
+    for (int16_t row = ty0; row <= ty1; row++) {
+        if (tx0 < damageX0[row]) damageX0[row] = tx0;
+        if (tx1 > damageX1[row]) damageX1[row] = tx1;
+    }
+}
+
+// Send the frame: either the whole buffer or only the damaged tile spans,
+// merging consecutive tile rows with the same span into one transfer
+void ESP32_MenuSystem::flushFrame() {
+    if (flushChunkRows > 0 && !inRenderTask()) {
+        // Sent a few tile rows per update() from the next call on
+        flushRow = 0;
+        flushActive = true;
+        return;
+    }
+
+    #ifdef MENU_ENABLE_STATS
+    uint32_t start = MENU_STATS_CYCLES();
+    #endif
+
+    if (frameFullFlush) {
+        display->sendBuffer();
+    } else {
+        uint8_t tileRows = display->getBufferTileHeight();
+        uint8_t row = 0;
+        while (row < tileRows) {
+            if (damageX0[row] > damageX1[row]) {
+                row++;
+                continue;
+            }
+
+            uint8_t x0 = damageX0[row];
+            uint8_t x1 = damageX1[row];
+            uint8_t rows = 1;
+            while (row + rows < tileRows && damageX0[row + rows] == x0 && damageX1[row + rows] == x1) {
+                rows++;
+            }
+
+            display->updateDisplayArea(x0, row, x1 - x0 + 1, rows);
+            row += rows;
+        }
+    }
+
+    #ifdef MENU_ENABLE_MIRROR
+    mirrorBegin();
+    mirrorRows(0, display->getBufferTileHeight(), false);
+    mirrorEnd();
+    #endif
+
+    #ifdef MENU_ENABLE_STATS
+    // The render task sends frames without holding the lock
+    lockState();
+    addSample(TIMING_FLUSH, MENU_STATS_CYCLES() - start);
+    noteFrameSent();
+    unlockState();
+    #endif
+}
+
+// Send the next flushChunkRows tile rows of a chunked flush. Undamaged
+// rows of a partial frame are skipped without counting.
+void ESP32_MenuSystem::continueFlush() {
+    #ifdef MENU_ENABLE_STATS
+    uint32_t start = MENU_STATS_CYCLES();
+    #endif
+
+    uint8_t tileRows = display->getBufferTileHeight();
+    uint8_t sent = 0;
+    while (flushRow < tileRows && sent < flushChunkRows) {
+        if (frameFullFlush) {
+            uint8_t rows = tileRows - flushRow;
+            if (rows > flushChunkRows - sent) rows = flushChunkRows - sent;
+            display->updateDisplayArea(0, flushRow, display->getBufferTileWidth(), rows);
+            flushRow += rows;
+            sent += rows;
+        } else {
+            uint8_t row = flushRow++;
+            if (damageX0[row] > damageX1[row]) continue;
+            display->updateDisplayArea(damageX0[row], row, damageX1[row] - damageX0[row] + 1, 1);
+            sent++;
+        }
+    }
+
+    if (flushRow >= tileRows) {
+        flushActive = false;
+        #ifdef MENU_ENABLE_MIRROR
+        mirrorBegin();
+        mirrorRows(0, tileRows, false);
+        mirrorEnd();
+        #endif
+    }
+
+    #ifdef MENU_ENABLE_STATS
+    addSample(TIMING_FLUSH, MENU_STATS_CYCLES() - start);
+    if (!flushActive) noteFrameSent();
+    #endif
+}
+
+void ESP32_MenuSystem::finishFlush() {
+    while (flushActive) {
+        continueFlush();
+    }
+}
+
+#ifdef MENU_ENABLE_MIRROR
+// PackBits over the span's bytes, XORed against base when it is set:
+// n < 0x80 is followed by n + 1 literal bytes, n >= 0x80 repeats the
+// next byte n - 0x7E times
+static inline uint8_t mirrorByte(const uint8_t* data, const uint8_t* base, size_t i) {
+    return base ? (data[i] ^ base[i]) : data[i];
+}
+
+static void writePackBits(Print* out, const uint8_t* data, const uint8_t* base, size_t length) {
+    uint8_t literal[128];
+    size_t i = 0;
+    while (i < length) {
+        uint8_t value = mirrorByte(data, base, i);
+        size_t run = 1;
+        while (i + run < length && run < 129 && mirrorByte(data, base, i + run) == value) {
+            run++;
+        }
+        if (run >= 2) {
+            out->write((uint8_t)(0x7E + run));
+            out->write(value);
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next repeated byte
+        size_t count = 0;
+        while (i < length && count < sizeof(literal)) {
+            if (i + 1 < length && mirrorByte(data, base, i) == mirrorByte(data, base, i + 1)) break;
+            literal[count++] = mirrorByte(data, base, i++);
+        }
+        out->write((uint8_t)(count - 1));
+        out->write(literal, count);
+    }
+}
+
+bool ESP32_MenuSystem::setMirror(Print* sink, bool delta) {
+    lockState();
+    bool ok = true;
+    if (sink && delta && !mirrorShadow) {
+        size_t size = display->getBufferTileWidth() * 8 * ((display->getDisplayHeight() + 7) / 8);
+        mirrorShadow = static_cast<uint8_t*>(calloc(size, 1));
+        ok = (mirrorShadow != nullptr);
+    }
+    mirrorDelta = delta && mirrorShadow;
+    mirrorSink = sink;
+
+    // Start the viewer off with the whole screen
+    mirrorKeyFrame = true;
+    needsRedraw = true;
+    unlockState();
+    return ok;
+}
+
+// The header is written with the first span, so frames that change
+// nothing write nothing
+void ESP32_MenuSystem::mirrorBegin() {
+    mirrorOut = nullptr;
+    mirrorXor = mirrorDelta && !mirrorKeyFrame;
+}
+
+// Write the changed parts of buffered tile rows firstRow.. (the page in
+// page buffer mode): against the shadow with delta, otherwise the spans
+// sent to the panel (wholeRows: the full rows)
+void ESP32_MenuSystem::mirrorRows(uint8_t firstRow, uint8_t rowCount, bool wholeRows) {
+    if (!mirrorSink) return;
+
+    uint8_t tileCols = display->getBufferTileWidth();
+    uint8_t displayRows = (display->getDisplayHeight() + 7) / 8;
+    size_t rowBytes = tileCols * 8;
+    const uint8_t* buffer = display->getBufferPtr();
+
+    for (uint8_t i = 0; i < rowCount && firstRow + i < displayRows; i++) {
+        uint8_t row = firstRow + i;
+        const uint8_t* data = buffer + i * rowBytes;
+        uint8_t x0 = 0;
+        uint8_t x1 = tileCols - 1;
+        if (mirrorKeyFrame) {
+            // Every tile
+        } else if (mirrorDelta) {
+            const uint8_t* shadow = mirrorShadow + row * rowBytes;
+            while (x0 < tileCols && memcmp(data + x0 * 8, shadow + x0 * 8, 8) == 0) x0++;
+            if (x0 == tileCols) continue;
+            while (memcmp(data + x1 * 8, shadow + x1 * 8, 8) == 0) x1--;
+        } else if (!wholeRows && !frameFullFlush) {
+            if (damageX0[row] > damageX1[row]) continue;
+            x0 = damageX0[row];
+            x1 = damageX1[row];
+        }
+        mirrorSpan(row, x0, x1 - x0 + 1, data + x0 * 8);
+    }
+}
+
+void ESP32_MenuSystem::mirrorSpan(uint8_t row, uint8_t x0, uint8_t count, const uint8_t* data) {
+    if (!mirrorOut) {
+        mirrorOut = mirrorSink;
+        const uint8_t header[4] = {
+            MIRROR_SYNC, (uint8_t)(mirrorXor ? MIRROR_FLAG_XOR : 0),
+            display->getBufferTileWidth(), (uint8_t)((display->getDisplayHeight() + 7) / 8)
+        };
+        mirrorOut->write(header, sizeof(header));
+    }
+
+    const uint8_t span[3] = { row, x0, count };
+    mirrorOut->write(span, sizeof(span));
+
+    size_t length = count * 8;
+    uint8_t* shadow = mirrorShadow ? mirrorShadow + (row * display->getBufferTileWidth() + x0) * 8 : nullptr;
+    writePackBits(mirrorOut, data, mirrorXor ? shadow : nullptr, length);
+    if (shadow) memcpy(shadow, data, length);
+}
+
+void ESP32_MenuSystem::mirrorEnd() {
+    if (mirrorOut) {
+        mirrorOut->write((uint8_t)MIRROR_END);
+        mirrorOut = nullptr;
+        mirrorKeyFrame = false;
+    }
+}
+#endif // MENU_ENABLE_MIRROR
+
+void ESP32_MenuSystem::setChunkedFlush(uint8_t tileRowsPerUpdate) {
+    lockState();
+    finishFlush();
+    flushChunkRows = tileRowsPerUpdate;
+    unlockState();
+}
+
+#ifdef MENU_ENABLE_STATS
+void ESP32_MenuSystem::addSample(uint8_t id, uint32_t value) {
+    if (timingWindows == nullptr) return;
+    TimingWindow& window = timingWindows[id];
+    window.samples[window.next] = value;
+    window.next = (window.next + 1) % MENU_STATS_WINDOW;
+    if (window.count < MENU_STATS_WINDOW) window.count++;
+}
+
+void ESP32_MenuSystem::summarize(uint8_t id, MenuTiming& timing) const {
+    timing.samples = (timingWindows != nullptr) ? timingWindows[id].count : 0;
+    if (timing.samples == 0) {
+        timing.last = timing.avg = timing.p99 = timing.max = 0;
+        return;
+    }
+    const TimingWindow& window = timingWindows[id];
+
+    timing.last = window.samples[(window.next + MENU_STATS_WINDOW - 1) % MENU_STATS_WINDOW];
+
+    // Sort a copy (insertion sort, the window is small)
+    uint32_t sorted[MENU_STATS_WINDOW];
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < window.count; i++) {
+        uint32_t value = window.samples[i];
+        total += value;
+        uint16_t j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    timing.avg = (uint32_t)(total / window.count);
+    timing.p99 = sorted[(window.count * 99 - 1) / 100];
+    timing.max = sorted[window.count - 1];
+}
+
+// Input changed what is shown: start the press-to-pixel clock unless an
+// earlier input is still waiting for its frame
+void ESP32_MenuSystem::noteInput(unsigned long timestamp) {
+    if (!inputPending) {
+        inputPending = true;
+        inputMarkMicros = timestamp;
+    }
+}
+
+void ESP32_MenuSystem::noteFrameSent() {
+    if (!inputPending) return;
+    inputPending = false;
+    addSample(TIMING_LATENCY, micros() - inputMarkMicros);
+}
+
+MenuStats ESP32_MenuSystem::getStats() {
+    MenuStats stats;
+    lockState();
+    summarize(TIMING_INPUT, stats.input);
+    summarize(TIMING_DRAW, stats.draw);
+    summarize(TIMING_FLUSH, stats.flush);
+    summarize(TIMING_LATENCY, stats.latency);
+    stats.framesRendered = framesRendered;
+    stats.framesSkipped = framesSkipped;
+    unlockState();
+    stats.cpuMhz = getCpuFrequencyMhz();
+    return stats;
 }
 
-void ESP32_MenuSystem::handleButtonPress() {
-    // Only applicable in encoder mode
-    if (inputMode != INPUT_ENCODER) return;
-    
-    // Read the state of the encoder button based on its trigger type
-    bool currentButtonState = (encoderButtonTriggerType == TRIGGER_LOW) ? 
-                             (digitalRead(encoderButtonPin) == LOW) : 
-                             (digitalRead(encoderButtonPin) == HIGH);
-    
-    // Check if the button state changed
-    if (currentButtonState != lastEncoderButtonState) {
-        lastDebounceTime = millis();
-    }
-    
-    // Debounce
-    if ((millis() - lastDebounceTime) > debounceDelay) {
-        if (currentButtonState != encoderButtonState) {
-            encoderButtonState = currentButtonState;
-            
-            if (encoderButtonState) {
-                if (errorCode > 0) {
-                    clearError();
-                } else if (isValueAdjustMode && currentValueAdjuster) {
-                    // Check for boolean adjuster
-                    if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-                        BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(currentValueAdjuster);
-                        // Apply the temporary selection to the actual value
-                        boolAdjuster->applyTempValue();
-                    }
-                    exitValueAdjustMode();
-                } else {
-                    select();
-                }
-            }
-        }
+void ESP32_MenuSystem::resetStats() {
+    lockState();
+    for (uint8_t id = 0; timingWindows != nullptr && id < TIMING_COUNT; id++) {
+        timingWindows[id].count = timingWindows[id].next = 0;
     }
-    
-    lastEncoderButtonState = currentButtonState;
+    framesRendered = 0;
+    framesSkipped = 0;
+    inputPending = false;
+    inputDrained = false;
+    unlockState();
 }
 
-void ESP32_MenuSystem::enterValueAdjustMode(ValueAdjuster* adjuster) {
-    isValueAdjustMode = true;
-    currentValueAdjuster = adjuster;
-    
-    // For boolean adjusters, initialize temp value to current value
-    if (adjuster->getType() == ADJUSTER_TYPE_BOOL) {
-        BoolValueAdjuster* boolAdjuster = static_cast<BoolValueAdjuster*>(adjuster);
-        boolAdjuster->setTempValue(boolAdjuster->isTrue());
+void ESP32_MenuSystem::setStatsOverlay(bool enable) {
+    statsOverlay = enable;
+    invalidate();
+}
+
+// Average draw / flush time and latency in microseconds, drawn over the
+// bottom right corner of whatever screen is shown
+void ESP32_MenuSystem::drawStatsOverlay() {
+    MenuTiming draw, flush, latency;
+    summarize(TIMING_DRAW, draw);
+    summarize(TIMING_FLUSH, flush);
+    summarize(TIMING_LATENCY, latency);
+    uint32_t mhz = getCpuFrequencyMhz();
+    if (mhz == 0) mhz = 1;
+
+    char text[36];  // Room for three 10 digit values
+    snprintf(text, sizeof(text), "D%lu F%lu L%lu",
+             (unsigned long)(draw.avg / mhz), (unsigned long)(flush.avg / mhz),
+             (unsigned long)latency.avg);
+
+    display->setFont(u8g2_font_4x6_tr);
+    int16_t w = display->getStrWidth(text) + 2;
+    int16_t h = 7;
+    int16_t x = screenWidth - w;
+    int16_t y = screenHeight - h;
+    if (useDisplayOffset) {
+        x += displayOffsetX;
+        y += displayOffsetY;
     }
-    
-    // If using encoder, reset count to prevent sudden jumps
-    if (inputMode == INPUT_ENCODER && encoder != nullptr) {
-        #ifdef USE_ESP32_ENCODER
-            lastEncoderValue = encoder->getCount();
-        #else
-            lastEncoderValue = encoder->read();
-        #endif
+
+    display->setDrawColor(0);
+    display->drawBox(x, y, w, h);
+    display->setDrawColor(1);
+    display->drawStr(x + 1, y + h - 1, text);
+
+    // New numbers every frame
+    markDamage(x, y, w, h);
+}
+#endif // MENU_ENABLE_STATS
+
+void ESP32_MenuSystem::setFrameRate(uint8_t fps) {
+    frameInterval = (fps > 0) ? 1000 / fps : 0;
+}
+
+void ESP32_MenuSystem::setAnimation(uint16_t durationMs) {
+    animationDuration = durationMs;
+    animationMenu = -1;
+    animating = false;
+    invalidate();
+}
+
+void ESP32_MenuSystem::snapMotion(Motion& motion, int32_t position) {
+    motion.from = position;
+    motion.to = position;
+    motion.start = frameTime - animationDuration;
+}
+
+// Position of a motion at frameTime, eased out with integer math:
+// from + (to - from) * (1 - (1 - t)^2). A new target starts a new motion
+// from wherever the old one had got to.
+int32_t ESP32_MenuSystem::moveMotion(Motion& motion, int32_t target) {
+    if (target != motion.to) {
+        int32_t current = moveMotion(motion, motion.to);
+        motion.from = current;
+        motion.to = target;
+        motion.start = frameTime;
     }
+
+    unsigned long elapsed = frameTime - motion.start;
+    if (elapsed >= animationDuration) return motion.to;
+
+    int32_t t = (int32_t)((elapsed * MOTION_ONE) / animationDuration);
+    int32_t remaining = MOTION_ONE - t;
+    int32_t eased = MOTION_ONE - (remaining * remaining) / MOTION_ONE;
+    return motion.from + (int32_t)(((int64_t)(motion.to - motion.from) * eased) / MOTION_ONE);
 }
 
-void ESP32_MenuSystem::displayMenu() {
+// Draw whichever screen is active into the buffer
+void ESP32_MenuSystem::drawScreen() {
     if (errorCode > 0) {
-        displayError();
-        return;
-    }
-    
-    if (isValueAdjustMode && currentValueAdjuster) {
-        // Check adjuster type
-        if (currentValueAdjuster->getType() == ADJUSTER_TYPE_BOOL) {
-            // Use boolean display 
-            displayBoolAdjust();
-        } else {
-            // Use standard value adjust display for other types
-            displayValueAdjust();
-        }
-        return;
+        drawError();
+    } else if (isValueAdjustMode && currentValueAdjuster) {
+        drawEditor();
+    } else {
+        drawMenuList();
     }
-    
+
+    #ifdef MENU_ENABLE_STATS
+    if (statsOverlay) drawStatsOverlay();
+    #endif
+}
+
+void ESP32_MenuSystem::drawMenuList() {
     Menu* currentMenu = getCurrentMenu();
     if (!currentMenu) return;
+
+    beginScreen(hashMix(SCREEN_MENU_LIST, currentMenuIndex));
+    if (!fontMetricsValid) cacheFontMetrics();
+
+    // A screen info callback may draw anywhere, so its menus are always sent whole
+    if (currentMenu->hasScreenInfo) frameFullFlush = true;
     
-    display->clearBuffer();
     display->setFont(titleFont);
     
     // Draw title - apply offset if enabled
@@ -645,8 +3021,9 @@ void ESP32_MenuSystem::displayMenu() {
         cursorX += displayOffsetX;
         cursorY += displayOffsetY;
     }
-    display->setCursor(cursorX, cursorY);
-    display->print(currentMenu->title);
+    drawLabel(cursorX, cursorY, currentMenu->title, titleFont, titleMetrics);
+    trackRegion(REGION_TITLE, hashString(0, currentMenu->title),
+                cursorX, cursorY - titleMetrics.ascent, screenWidth, titleHeight);
     
     // Draw separator line - apply offset if enabled
     int16_t lineX = 0;
@@ -658,6 +3035,8 @@ void ESP32_MenuSystem::displayMenu() {
     display->drawHLine(lineX, lineY, screenWidth);
     
     display->setFont(standardFont);
+    int8_t rowAscent = standardMetrics.ascent;
+    int8_t rowDescent = standardMetrics.descent;
 
     // Determine how many items will be visible
     int visibleItems = menuItemsVisible;  // Default (calculated based on screen size)
@@ -667,27 +3046,73 @@ void ESP32_MenuSystem::displayMenu() {
         visibleItems = currentMenu->maxVisibleItems;
     }
     
-    // Calculate which items to display (for scrolling support)
-    int displayStart = 0;
-    
-    // If cursor position is outside visible area, adjust start position
-    if (cursorPosition >= visibleItems) {
-        displayStart = cursorPosition - visibleItems + 1;
+    // A data source may have shrunk since the cursor was placed
+    int itemCount = currentMenu->getItemCount();
+    if (cursorPosition >= itemCount) {
+        cursorPosition = (itemCount > 0) ? itemCount - 1 : 0;
+    }
+
+    // Scroll only as far as needed to keep the cursor visible; the offset
+    // persists so goBack() can restore the view
+    if (cursorPosition < scrollOffset) {
+        scrollOffset = cursorPosition;
+    } else if (cursorPosition >= scrollOffset + visibleItems) {
+        scrollOffset = cursorPosition - visibleItems + 1;
     }
     
     // Make sure we don't try to display past the end
-    if (displayStart + visibleItems > currentMenu->itemCount) {
-        displayStart = currentMenu->itemCount - visibleItems;
-        if (displayStart < 0) displayStart = 0;
+    if (scrollOffset + visibleItems > itemCount) {
+        scrollOffset = itemCount - visibleItems;
+    }
+    if (scrollOffset < 0) scrollOffset = 0;
+    int displayStart = scrollOffset;
+    int rowCount = visibleItems;
+    int16_t rowPitch = rowY[1] - rowY[0];
+    int16_t rowShift = 0;
+
+    // Animated list: the view and the cursor glide to their new rows
+    int32_t cursorMotionPos = 0;
+    int32_t scrollMotionPos = 0;
+    if (animationDuration > 0) {
+        if (animationMenu != currentMenuIndex) {
+            // A different menu appears at once
+            animationMenu = currentMenuIndex;
+            snapMotion(scrollMotion, (int32_t)scrollOffset * MOTION_ONE);
+            snapMotion(cursorMotion, (int32_t)cursorPosition * MOTION_ONE);
+        }
+        scrollMotionPos = moveMotion(scrollMotion, (int32_t)scrollOffset * MOTION_ONE);
+        cursorMotionPos = moveMotion(cursorMotion, (int32_t)cursorPosition * MOTION_ONE);
+
+        bool scrolling = scrollMotionPos != (int32_t)scrollOffset * MOTION_ONE;
+        if (scrolling || cursorMotionPos != (int32_t)cursorPosition * MOTION_ONE) {
+            animating = true;
+            // Rows move between tiles; send this frame and the settled one whole
+            frameFullFlush = true;
+            needsFullFlush = true;
+        }
+        if (scrolling) {
+            // Draw one extra row, clipped to the list area
+            displayStart = scrollMotionPos / MOTION_ONE;
+            rowShift = (int16_t)(((scrollMotionPos % MOTION_ONE) * rowPitch) / MOTION_ONE);
+            rowCount = visibleItems + 1;
+
+            int16_t clipTop = separatorY + 1;
+            int16_t clipBottom = rowY[0] + (visibleItems - 1) * rowPitch - rowDescent + 1;
+            if (useDisplayOffset) {
+                clipTop += displayOffsetY;
+                clipBottom += displayOffsetY;
+            }
+            display->setClipWindow(0, clipTop, screenWidth + (useDisplayOffset ? displayOffsetX : 0), clipBottom);
+        }
     }
     
     // Display the visible items
-    for (int i = 0; i < visibleItems && (i + displayStart) < currentMenu->itemCount; i++) {
+    for (int i = 0; i < rowCount && (i + displayStart) < itemCount; i++) {
         int itemIndex = i + displayStart;
         
-        // Calculate Y position with minimal spacing
-        int16_t yPos = menuStartY + i * (getFontHeight(standardFont) + menuItemPadding);  // Minimal 1px padding
-        // ...menuItemPadding
+        // Row baselines come from the layout cache
+        int16_t yPos = (i < MAX_VISIBLE_ROWS) ? rowY[i] : rowY[0] + i * rowPitch;
+        yPos -= rowShift;
         int16_t leftX = 0;
         int16_t indentedX = 10;
         
@@ -697,59 +3122,99 @@ void ESP32_MenuSystem::displayMenu() {
             indentedX += displayOffsetX;
         }
         
-        if (itemIndex == cursorPosition) {
+        // With animation the cursor is drawn on its own, at its animated position
+        int16_t nameX = indentedX;
+        if (animationDuration == 0 && itemIndex == cursorPosition) {
             display->setCursor(leftX, yPos);
             display->print("> ");
+            nameX = display->tx;     // Print cursor after the marker
+        }
+        const char* itemName;
+        if (currentMenu->dataSource) {
+            // Changing text: printed
+            itemName = listRowText(*currentMenu, itemIndex);
+            display->setCursor(nameX, yPos);
+            display->print(itemName);
         } else {
-            display->setCursor(indentedX, yPos);
+            // Rows moving under the clip window are not captured
+            itemName = currentMenu->items[itemIndex].name;
+            drawLabel(nameX, yPos, itemName, standardFont, standardMetrics, rowShift == 0);
         }
-        display->print(currentMenu->items[itemIndex].name);
+
+        // Row content key: which item, whether it is selected and its value text
+        uint32_t rowKey = hashMix(hashMix(0, itemIndex), itemIndex == cursorPosition);
+        rowKey = hashString(rowKey, itemName);
         
         // If this item has a value adjuster, show the current value
-        if (currentMenu->items[itemIndex].valueAdjuster != nullptr) {
+        if (!currentMenu->dataSource && currentMenu->items[itemIndex].valueAdjuster != nullptr) {
             ValueAdjuster* adjuster = currentMenu->items[itemIndex].valueAdjuster;
-            float value = adjuster->getValue();
-            int decimals = adjuster->getDecimalPlaces();
-            const char* unit = adjuster->getUnit();
-            
-            // Format value string based on decimals
-            char valueStr[20];
-            if (decimals > 0) {
-                char format[10];
-                sprintf(format, "%%.%df", decimals);
-                sprintf(valueStr, format, value);
-            } else {
-                sprintf(valueStr, "%.0f", value);
+            RowValueCache& cache = rowValueCache[itemIndex % MAX_VISIBLE_ROWS];
+            uint32_t valueKey = adjusterValueKey(adjuster);
+
+            // Format value + unit (and re-measure it) only when the value changed
+            if (cache.adjuster != adjuster || cache.valueKey != valueKey) {
+                char rowText[MENU_VALUE_TEXT_LENGTH];
+                formatAdjuster(adjuster, rowText, sizeof(rowText), ADJUSTER_PART_VALUE, true);
+
+                measureText(cache.text, rowText);
+                cache.adjuster = adjuster;
+                cache.valueKey = valueKey;
+            } else if (cache.text.fontGeneration != fontGeneration) {
+                cache.text.width = display->getStrWidth(cache.text.text);
+                cache.text.fontGeneration = fontGeneration;
             }
-            
-            // Display value at right side of screen - adjust for screen width
-            int16_t xPos = screenWidth - (strlen(valueStr) + strlen(unit) + 1) * 6;
+
+            // Display value at right side of screen, one character cell from the edge
+            int16_t xPos = screenWidth - cache.text.width - standardMetrics.width;
             if (useDisplayOffset) {
                 xPos += displayOffsetX;
             }
             display->setCursor(xPos, yPos);
-            display->print(valueStr);
-            display->print(unit);
+            display->print(cache.text.text);
+
+            rowKey = hashString(rowKey, cache.text.text);
+        }
+
+        if (REGION_ROW_FIRST + i < REGION_COUNT) {
+            trackRegion(REGION_ROW_FIRST + i, rowKey, 0, yPos - rowAscent,
+                        screenWidth + (useDisplayOffset ? displayOffsetX : 0),
+                        rowAscent - rowDescent + 1);
+        } else {
+            frameFullFlush = true;
+        }
+    }
+
+    if (animationDuration > 0 && itemCount > 0) {
+        display->setMaxClipWindow();
+
+        // Cursor marker between the rows it moves across
+        int16_t markerY = rowY[0] + (int16_t)(((cursorMotionPos - scrollMotionPos) * rowPitch) / MOTION_ONE);
+        int16_t markerX = 0;
+        if (useDisplayOffset) {
+            markerX += displayOffsetX;
+            markerY += displayOffsetY;
         }
+        display->setCursor(markerX, markerY);
+        display->print(">");
     }
 
     // Draw scroll indicator if needed (if there are more items than visible)
-    bool needScrolling = currentMenu->itemCount > visibleItems;
+    bool needScrolling = itemCount > visibleItems;
     if (needScrolling) {
         // Calculate scroll bar height and position
         int availableScrollHeight = visibleItems * lineHeight;
-        int scrollBarHeight = (visibleItems * availableScrollHeight) / currentMenu->itemCount;
+        int scrollBarHeight = (visibleItems * availableScrollHeight) / itemCount;
         if (scrollBarHeight < 4) scrollBarHeight = 4; // Minimum size
         
         int16_t scrollBarY = menuStartY;
-        if (currentMenu->itemCount > 1) {  // Avoid division by zero
+        if (itemCount > 1) {  // Avoid division by zero
             scrollBarY += (cursorPosition * (availableScrollHeight - scrollBarHeight)) / 
-                          (currentMenu->itemCount - 1);
+                          (itemCount - 1);
         }
         
         // Apply offset if enabled
         int16_t scrollBarX = screenWidth - scrollIndicatorWidth;
-        int16_t startY = menuStartY - (getFontHeight(standardFont) / 2);
+        int16_t startY = menuStartY - (standardMetrics.height / 2);
         
         if (useDisplayOffset) {
             scrollBarX += displayOffsetX;
@@ -760,12 +3225,12 @@ void ESP32_MenuSystem::displayMenu() {
         // Draw scroll bar at the right edge
         display->drawVLine(scrollBarX, startY, availableScrollHeight);
         display->drawBox(scrollBarX, scrollBarY, scrollIndicatorWidth, scrollBarHeight);
-    }
 
-    // Get the selected item, if any
-    MenuItem* selectedItem = nullptr;
-    if (cursorPosition < currentMenu->itemCount) {
-        selectedItem = &currentMenu->items[cursorPosition];
+        int16_t scrollEndY = scrollBarY + scrollBarHeight;
+        int16_t trackEndY = startY + availableScrollHeight;
+        trackRegion(REGION_SCROLLBAR, hashMix(hashMix(0, scrollBarY), scrollBarHeight),
+                    scrollBarX, startY, scrollIndicatorWidth,
+                    ((scrollEndY > trackEndY) ? scrollEndY : trackEndY) - startY);
     }
 
     // Call screen info callback if available
@@ -775,18 +3240,269 @@ void ESP32_MenuSystem::displayMenu() {
         currentMenu->screenInfoCallback();
     }
 
-    display->sendBuffer();
+    drawInfoRegions(false);
 }
 
 void ESP32_MenuSystem::addScreenInfo(int menuIndex, ScreenInfoCallback callback) {
-    if (menuIndex >= 0 && menuIndex < menuCount) {
-        menus[menuIndex].setScreenInfoCallback(callback);
+    if (menuIndex >= 0 && menuIndex < model->menuCount) {
+        model->menus[menuIndex].setScreenInfoCallback(callback);
+        model->revision++;
+        if (menuIndex == currentMenuIndex) needsRedraw = true;
+    }
+}
+
+int ESP32_MenuSystem::addScreenInfoRegion(int menuIndex, int16_t x, int16_t y, int16_t w, int16_t h,
+                                          ScreenInfoCallback callback, unsigned long intervalMs) {
+    if (menuIndex < 0 || menuIndex >= model->menuCount || !callback || w <= 0 || h <= 0) return -1;
+    if (infoRegionCount >= MAX_SCREEN_INFO_REGIONS) return -1;
+    if (infoRegions == nullptr) {
+        infoRegions = static_cast<ScreenInfoRegion*>(malloc(MAX_SCREEN_INFO_REGIONS * sizeof(ScreenInfoRegion)));
+        if (infoRegions == nullptr) return -1;
+    }
+
+    ScreenInfoRegion& region = infoRegions[infoRegionCount];
+    region.menuIndex = menuIndex;
+    region.x = x;
+    region.y = y;
+    region.w = w;
+    region.h = h;
+    region.callback = callback;
+    region.interval = intervalMs;
+    region.lastDraw = millis();
+    region.dirty = true;
+    return infoRegionCount++;
+}
+
+void ESP32_MenuSystem::markDirty(int region) {
+    if (region >= 0 && region < infoRegionCount) {
+        infoRegions[region].dirty = true;
+    }
+}
+
+bool ESP32_MenuSystem::infoRegionDue(const ScreenInfoRegion& region, unsigned long now, bool timers) const {
+    if (region.dirty) return true;
+    return timers && region.interval > 0 && now - region.lastDraw >= region.interval;
+}
+
+// Only regions of the menu list on screen are drawn
+bool ESP32_MenuSystem::infoRegionsDue(unsigned long now, bool timers) const {
+    if (isValueAdjustMode || errorCode != 0) return false;
+    for (uint8_t i = 0; i < infoRegionCount; i++) {
+        const ScreenInfoRegion& region = infoRegions[i];
+        if (region.menuIndex == currentMenuIndex && infoRegionDue(region, now, timers)) return true;
+    }
+    return false;
+}
+
+// Draw the current menu's regions clipped to their boxes. During a full
+// frame every region is drawn; otherwise only the due ones, each cleared
+// first since the buffer still holds the previous frame.
+void ESP32_MenuSystem::drawInfoRegions(bool dueOnly) {
+    for (uint8_t i = 0; i < infoRegionCount; i++) {
+        ScreenInfoRegion& region = infoRegions[i];
+        if (region.menuIndex != currentMenuIndex) continue;
+        if (dueOnly && !infoRegionDue(region, frameTime, idleState == IDLE_ACTIVE)) continue;
+
+        if (dueOnly) {
+            display->setDrawColor(0);
+            display->drawBox(region.x, region.y, region.w, region.h);
+            display->setDrawColor(1);
+        }
+        display->setClipWindow(region.x, region.y, region.x + region.w, region.y + region.h);
+        region.callback();
+        display->setMaxClipWindow();
+        markDamage(region.x, region.y, region.w, region.h);
+
+        region.lastDraw = frameTime;
+        region.dirty = false;
+    }
+}
+
+// Redraw the due regions into the frame already in the buffer; only
+// their tiles are left to send
+void ESP32_MenuSystem::drawRegionFrame() {
+    finishFlush();
+    frameTime = millis();
+
+    #ifdef MENU_ENABLE_STATS
+    uint32_t start = MENU_STATS_CYCLES();
+    framesRendered++;
+    #endif
+
+    frameFullFlush = !canSendPartial();
+    for (uint8_t row = 0; row < MAX_DISPLAY_TILE_ROWS; row++) {
+        damageX0[row] = 0xFF;
+        damageX1[row] = 0;
     }
+    drawInfoRegions(true);
+
+    #ifdef MENU_ENABLE_STATS
+    addSample(TIMING_DRAW, MENU_STATS_CYCLES() - start);
+    #endif
 }
 
 void ESP32_MenuSystem::exitValueAdjustMode() {
     isValueAdjustMode = false;
     currentValueAdjuster = nullptr;
+    currentEditor = nullptr;
+    needsRedraw = true;
+    // Save after the frame leaving the editor is drawn
+    if (persist) persist->saveNow = true;
+}
+
+// Persistence state is allocated by the first persistValue() or setPersistence()
+ESP32_MenuSystem::PersistState* ESP32_MenuSystem::persistState() {
+    if (persist == nullptr) {
+        persist = static_cast<PersistState*>(calloc(1, sizeof(PersistState)));
+        if (persist == nullptr) return nullptr;
+        persist->nvsNamespace = "menu";
+        persist->delay = 2000;
+    }
+    return persist;
+}
+
+bool ESP32_MenuSystem::persistValue(ValueAdjuster* adjuster, const char* key) {
+    if (!adjuster || !key) return false;
+    if (strlen(key) == 0 || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) return false;
+    if (persistState() == nullptr || persist->count >= MAX_PERSISTED_VALUES) return false;
+
+    PersistState::Value& value = persist->values[persist->count++];
+    value.adjuster = adjuster;
+    value.key = key;
+    value.saved = valueBits(adjuster);
+    return true;
+}
+
+void ESP32_MenuSystem::setPersistence(const char* nvsNamespace, unsigned long delayMs) {
+    if (persistState() == nullptr) return;
+    persist->nvsNamespace = nvsNamespace;
+    persist->delay = delayMs;
+}
+
+uint32_t ESP32_MenuSystem::valueBits(ValueAdjuster* adjuster) {
+    uint32_t bits = 0;
+    float value;
+    switch (adjuster->getKind()) {
+        case ADJUSTER_KIND_FLOAT:
+            memcpy(&bits, adjuster->target, sizeof(bits));
+            break;
+        case ADJUSTER_KIND_INT:
+        case ADJUSTER_KIND_ENUM:
+            bits = (uint32_t)*static_cast<int*>(adjuster->target);
+            break;
+        case ADJUSTER_KIND_FIXED:
+            bits = (uint32_t)*static_cast<int32_t*>(adjuster->target);
+            break;
+        case ADJUSTER_KIND_BOOL:
+            bits = *static_cast<bool*>(adjuster->target) ? 1 : 0;
+            break;
+        default:
+            value = adjuster->getValue();
+            memcpy(&bits, &value, sizeof(bits));
+            break;
+    }
+    return bits;
+}
+
+// Values are clamped into the adjuster's current range
+void ESP32_MenuSystem::applyValueBits(ValueAdjuster* adjuster, uint32_t bits) {
+    float value;
+    switch (adjuster->getKind()) {
+        case ADJUSTER_KIND_FLOAT:
+            memcpy(&value, &bits, sizeof(value));
+            if (isnan(value)) return;
+            *static_cast<float*>(adjuster->target) =
+                ValueAdjuster::limit(value, adjuster->range.f.min, adjuster->range.f.max, false);
+            break;
+        case ADJUSTER_KIND_INT:
+        case ADJUSTER_KIND_ENUM:
+            *static_cast<int*>(adjuster->target) =
+                ValueAdjuster::limit<int32_t>((int32_t)bits, adjuster->range.i.min, adjuster->range.i.max, false);
+            break;
+        case ADJUSTER_KIND_FIXED:
+            *static_cast<int32_t*>(adjuster->target) =
+                ValueAdjuster::limit<int32_t>((int32_t)bits, adjuster->range.i.min, adjuster->range.i.max, false);
+            break;
+        case ADJUSTER_KIND_BOOL:
+            *static_cast<bool*>(adjuster->target) = (bits != 0);
+            break;
+        default:
+            memcpy(&value, &bits, sizeof(value));
+            if (!isnan(value)) adjuster->setValue(value);
+            return;
+    }
+    adjuster->markChanged();
+}
+
+// Read every registered value back from NVS. Keys that were never saved
+// keep their current value. Returns false if the namespace does not exist
+// yet (nothing saved so far).
+bool ESP32_MenuSystem::loadSettings() {
+    if (persist == nullptr) return false;
+    lockState();
+    nvs_handle_t handle;
+    bool opened = (nvs_open(persist->nvsNamespace, NVS_READONLY, &handle) == ESP_OK);
+    for (uint8_t i = 0; i < persist->count; i++) {
+        PersistState::Value& value = persist->values[i];
+        uint32_t bits;
+        if (opened && nvs_get_u32(handle, value.key, &bits) == ESP_OK) {
+            applyValueBits(value.adjuster, bits);
+        }
+        value.saved = valueBits(value.adjuster);
+    }
+    if (opened) nvs_close(handle);
+
+    // Loaded values are not changes to save
+    persist->revision = adjusterRevisionKey(true);
+    persist->dirty = false;
+    needsRedraw = true;
+    unlockState();
+    return opened;
+}
+
+// Write the values that differ from NVS and commit them together
+bool ESP32_MenuSystem::saveSettings() {
+    if (persist == nullptr) return true;
+    lockState();
+    persist->dirty = false;
+    persist->saveNow = false;
+
+    nvs_handle_t handle = 0;
+    bool opened = false;
+    bool ok = true;
+    for (uint8_t i = 0; i < persist->count && ok; i++) {
+        PersistState::Value& value = persist->values[i];
+        uint32_t bits = valueBits(value.adjuster);
+        if (bits == value.saved) continue;
+
+        if (!opened) {
+            ok = opened = (nvs_open(persist->nvsNamespace, NVS_READWRITE, &handle) == ESP_OK);
+            if (!ok) break;
+        }
+        ok = (nvs_set_u32(handle, value.key, bits) == ESP_OK);
+        if (ok) value.saved = bits;
+    }
+    if (opened) {
+        if (ok) ok = (nvs_commit(handle) == ESP_OK);
+        nvs_close(handle);
+    }
+    unlockState();
+    return ok;
+}
+
+// Called from update(): restart the delay on every change, then save once
+void ESP32_MenuSystem::updatePersistence() {
+    unsigned long now = millis();
+    uint32_t revisionKey = adjusterRevisionKey(true);
+    if (revisionKey != persist->revision) {
+        persist->revision = revisionKey;
+        persist->changedAt = now;
+        persist->dirty = true;
+    }
+
+    bool due = persist->dirty && (persist->saveNow || now - persist->changedAt >= persist->delay);
+    persist->saveNow = false;
+    if (due) saveSettings();
 }
 
 void ESP32_MenuSystem::displayValueAdjust() {
@@ -794,16 +3510,17 @@ void ESP32_MenuSystem::displayValueAdjust() {
         exitValueAdjustMode();
         return;
     }
-    
-    // Get the value and other properties
-    float value = currentValueAdjuster->getValue();
-    float min = currentValueAdjuster->getMin();
-    float max = currentValueAdjuster->getMax();
-    float increment = currentValueAdjuster->getIncrement();
-    int decimals = currentValueAdjuster->getDecimalPlaces();
-    const char* unit = currentValueAdjuster->getUnit();
-    
-    display->clearBuffer();
+
+    renderFrame(&ESP32_MenuSystem::drawValueAdjust);
+}
+
+void ESP32_MenuSystem::drawValueAdjust() {
+    const char* unit = adjusterUnit(currentValueAdjuster);
+
+    // Title, separator and range labels stay put while adjusting; only the
+    // value line and the slider marker are tracked
+    beginScreen(hashMix(SCREEN_VALUE_ADJUST, (uint32_t)(uintptr_t)currentValueAdjuster));
+    if (!fontMetricsValid) cacheFontMetrics();
     
     // Title - apply offset if enabled
     display->setFont(titleFont);
@@ -840,18 +3557,12 @@ void ESP32_MenuSystem::displayValueAdjust() {
     display->setFont(valueFont);
     
     // Format value string based on decimals
-    char valueStr[20];
-    if (decimals > 0) {
-        char format[10];
-        sprintf(format, "%%.%df", decimals);
-        sprintf(valueStr, format, value);
-    } else {
-        sprintf(valueStr, "%.0f", value);
-    }
+    char valueStr[MENU_VALUE_TEXT_LENGTH];
+    formatAdjuster(currentValueAdjuster, valueStr, sizeof(valueStr), ADJUSTER_PART_VALUE, false);
     
     // Center the value display and apply offset if enabled
     int valueY = screenHeight * 0.55;  // 55% down the screen
-    int strWidth = strlen(valueStr) * 10;  // Approximate width
+    int strWidth = measureText(adjustValueWidth, valueStr);
     int xPos = (screenWidth - strWidth) / 2;
     if (useDisplayOffset) {
         xPos += displayOffsetX;
@@ -859,6 +3570,9 @@ void ESP32_MenuSystem::displayValueAdjust() {
     }
     display->setCursor(xPos, valueY);
     display->print(valueStr);
+    trackRegion(REGION_VALUE, hashString(0, valueStr), 0, valueY - valueMetrics.ascent,
+                screenWidth + (useDisplayOffset ? displayOffsetX : 0),
+                valueMetrics.ascent - valueMetrics.descent + 1);
     
     // Unit text with offset
     display->setFont(standardFont);
@@ -871,24 +3585,19 @@ void ESP32_MenuSystem::displayValueAdjust() {
     display->drawHLine(sliderX, sliderY, sliderWidth);
     
     // Calculate position marker based on value's position in range
-    int markerPos = sliderX + (int)(sliderWidth * (value - min) / (max - min));
+    int markerPos = sliderX + adjusterMarker(currentValueAdjuster, sliderWidth);
     
     // Draw marker box with offset already applied to markerPos
     display->drawBox(markerPos - 2, sliderY - 2, 5, 5);
+    trackRegion(REGION_SLIDER, hashMix(0, markerPos), 0, sliderY - 2,
+                screenWidth + (useDisplayOffset ? displayOffsetX : 0), 5);
     
     // Min and max values with offset
     display->setFont(standardFont);
     
-    char minStr[10], maxStr[10];
-    if (decimals > 0) {
-        char format[10];
-        sprintf(format, "%%.%df", decimals);
-        sprintf(minStr, format, min);
-        sprintf(maxStr, format, max);
-    } else {
-        sprintf(minStr, "%.0f", min);
-        sprintf(maxStr, "%.0f", max);
-    }
+    char minStr[MENU_VALUE_TEXT_LENGTH], maxStr[MENU_VALUE_TEXT_LENGTH];
+    formatAdjuster(currentValueAdjuster, minStr, sizeof(minStr), ADJUSTER_PART_MIN, false);
+    formatAdjuster(currentValueAdjuster, maxStr, sizeof(maxStr), ADJUSTER_PART_MAX, false);
     
     // Min value with offset
     int16_t minX = sliderX;
@@ -897,23 +3606,31 @@ void ESP32_MenuSystem::displayValueAdjust() {
     display->print(minStr);
     
     // Max value with offset
-    int maxWidth = strlen(maxStr) * 6;  // Approximate width of text
+    int maxWidth = measureText(adjustMaxWidth, maxStr);
     int16_t maxX = sliderX + sliderWidth - maxWidth;
     int16_t maxY = sliderY + 10;
     display->setCursor(maxX, maxY);
     display->print(maxStr);
-    
-    display->sendBuffer();
 }
 
 
 // Update the displayBoolAdjust method
 void ESP32_MenuSystem::displayBoolAdjust()
 {
-    // Safe cast - we already checked type in displayMenu
-    BoolValueAdjuster *boolAdjuster = static_cast<BoolValueAdjuster *>(currentValueAdjuster);
+    if (!currentValueAdjuster) {
+        exitValueAdjustMode();
+        return;
+    }
 
-    display->clearBuffer();
+    renderFrame(&ESP32_MenuSystem::drawBoolAdjust);
+}
+
+void ESP32_MenuSystem::drawBoolAdjust()
+{
+    // Safe cast - we already checked type in drawScreen
+    BoolValueAdjuster *boolAdjuster = static_cast<BoolValueAdjuster *>(currentValueAdjuster);
+    beginScreen(hashMix(SCREEN_BOOL_ADJUST, (uint32_t)(uintptr_t)currentValueAdjuster));
+    if (!fontMetricsValid) cacheFontMetrics();
 
     // Title
     display->setFont(titleFont);
@@ -970,6 +3687,12 @@ void ESP32_MenuSystem::displayBoolAdjust()
     display->print("is set to ");
     display->print(boolAdjuster->getCurrentLabel());
 
+    int8_t rowAscent = standardMetrics.ascent;
+    int8_t rowHeight = rowAscent - standardMetrics.descent + 1;
+    int16_t rowWidth = screenWidth + (useDisplayOffset ? displayOffsetX : 0);
+    trackRegion(REGION_VALUE, hashString(0, boolAdjuster->getCurrentLabel()),
+                0, currentValueY + 10 - rowAscent, rowWidth, rowHeight);
+
     // Show options with selection indicator
     bool tempValue = boolAdjuster->getTempValue();
 
@@ -991,22 +3714,208 @@ void ESP32_MenuSystem::displayBoolAdjust()
         display->setCursor(indentedX, optionsStartY + optionSpacing);
     }
     display->print(boolAdjuster->getFalseLabel());
-    display->sendBuffer();
+
+    // Both option rows move the selection marker together
+    trackRegion(REGION_ROW_FIRST, hashMix(0, tempValue), 0, optionsStartY - rowAscent,
+                rowWidth, optionSpacing + rowHeight);
+}
+
+#ifdef MENU_ENABLE_GLYPH_CACHE
+struct ESP32_MenuSystem::GlyphCacheEntry {
+    const char* text;         // nullptr = empty
+    uint32_t hash;            // Of the text when captured
+    const uint8_t* font;
+    uint8_t fontGeneration;
+    int8_t ascent;
+    uint8_t width;
+    uint8_t height;
+    uint32_t lastUse;
+    uint8_t bits[MENU_GLYPH_CACHE_BYTES];   // XBM: rows of LSB-first bytes
+};
+#endif
+
+void ESP32_MenuSystem::drawLabel(int16_t x, int16_t y, const char* text, const uint8_t* font,
+                                 const FontMetrics& metrics, bool capture) {
+    #ifdef MENU_ENABLE_GLYPH_CACHE
+    uint32_t hash = hashString(0, text);
+    GlyphCacheEntry* oldest = glyphCache;
+    for (uint8_t i = 0; glyphCache != nullptr && i < MENU_GLYPH_CACHE_SLOTS; i++) {
+        GlyphCacheEntry& entry = glyphCache[i];
+        if (entry.text == text && entry.hash == hash && entry.font == font &&
+            entry.fontGeneration == fontGeneration) {
+            entry.lastUse = ++glyphClock;
+            display->drawXBM(x, y - entry.ascent, entry.width, entry.height, entry.bits);
+            return;
+        }
+        if (entry.lastUse < oldest->lastUse) oldest = &entry;
+    }
+    #endif
+
+    display->setCursor(x, y);
+    display->print(text);
+
+    #ifdef MENU_ENABLE_GLYPH_CACHE
+    // Only whole labels in the full buffer are captured, and only ASCII:
+    // getStrWidth() does not measure UTF-8
+    if (!capture || !glyphCapture || pageBufferMode) return;
+    for (const char* c = text; *c; c++) {
+        if (*c & 0x80) return;
+    }
+    int16_t top = y - metrics.ascent;
+    int16_t width = display->getStrWidth(text);
+    int16_t height = metrics.ascent - metrics.descent + 1;
+    if (x < 0 || top < 0 || width <= 0 || width > 255 || height > 255) return;
+    if (x + width > display->getBufferTileWidth() * 8) return;
+    if (top + height > display->getBufferTileHeight() * 8) return;
+    if (((width + 7) / 8) * height > MENU_GLYPH_CACHE_BYTES) return;
+
+    oldest->text = text;
+    oldest->hash = hash;
+    oldest->font = font;
+    oldest->fontGeneration = fontGeneration;
+    oldest->ascent = metrics.ascent;
+    oldest->width = width;
+    oldest->height = height;
+    oldest->lastUse = ++glyphClock;
+    captureLabel(*oldest, x, top);
+    #endif
+}
+
+#ifdef MENU_ENABLE_GLYPH_CACHE
+// Labels are copied out of the buffer assuming U8g2's tile layout (one
+// byte per column of 8 pixel rows) without rotation. Other layouts
+// (horizontal controllers, rotated or mirrored displays) print every time.
+void ESP32_MenuSystem::checkGlyphBuffer() {
+    glyphCapture = false;
+    if (bufferLayout != BUFFER_TILES_VERTICAL) return;
+
+    // Zeroed slots are empty; kept across begin() calls
+    if (glyphCache == nullptr) {
+        glyphCache = static_cast<GlyphCacheEntry*>(calloc(MENU_GLYPH_CACHE_SLOTS, sizeof(GlyphCacheEntry)));
+        if (glyphCache == nullptr) return;
+    }
+
+    glyphCapture = true;
+}
+
+// Copy label pixels from the buffer (cleared before the frame, so the box
+// holds only the label) into the entry's XBM bitmap
+void ESP32_MenuSystem::captureLabel(GlyphCacheEntry& entry, int16_t x, int16_t top) {
+    const uint8_t* buffer = display->getBufferPtr();
+    uint16_t stride = display->getBufferTileWidth() * 8;
+    uint8_t rowBytes = (entry.width + 7) / 8;
+    memset(entry.bits, 0, rowBytes * entry.height);
+
+    for (uint8_t row = 0; row < entry.height; row++) {
+        int16_t y = top + row;
+        const uint8_t* column = buffer + (y >> 3) * stride + x;
+        uint8_t mask = 1 << (y & 7);
+        uint8_t* out = entry.bits + row * rowBytes;
+        for (uint8_t col = 0; col < entry.width; col++) {
+            if (column[col] & mask) out[col >> 3] |= 1 << (col & 7);
+        }
+    }
+}
+#endif
+
+// The built-in editors track their regions; a custom editor may draw
+// anywhere, so its frames are sent whole
+void ESP32_MenuSystem::drawEditor() {
+    if (currentEditor != &sliderEditor && currentEditor != &choiceEditor && currentEditor != &listEditor) {
+        beginScreen(hashMix(SCREEN_EDITOR, (uint32_t)(uintptr_t)currentEditor));
+        frameFullFlush = true;
+    }
+    currentEditor->draw(*this, currentValueAdjuster);
+}
+
+// Enum options as a list, paged so the current option is on screen
+void ESP32_MenuSystem::drawOptionList() {
+    EnumValueAdjuster* enumAdjuster = static_cast<EnumValueAdjuster*>(currentValueAdjuster);
+    beginScreen(hashMix(SCREEN_OPTION_LIST, (uint32_t)(uintptr_t)currentValueAdjuster));
+    if (!fontMetricsValid) cacheFontMetrics();
+
+    // Title: the item being adjusted
+    display->setFont(titleFont);
+    int16_t titleX = 0;
+    int16_t titleY = titleHeight - 2;
+    int16_t sepX = 0;
+    int16_t sepY = separatorY;
+    if (useDisplayOffset) {
+        titleX += displayOffsetX;
+        titleY += displayOffsetY;
+        sepX += displayOffsetX;
+        sepY += displayOffsetY;
+    }
+    Menu* currentMenu = getCurrentMenu();
+    display->setCursor(titleX, titleY);
+    if (currentMenu && cursorPosition < currentMenu->itemCount) {
+        display->print(currentMenu->items[cursorPosition].name);
+    } else {
+        display->print("Select");
+    }
+    display->drawHLine(sepX, sepY, screenWidth);
+
+    display->setFont(standardFont);
+    int8_t rowAscent = standardMetrics.ascent;
+    int8_t rowHeight = rowAscent - standardMetrics.descent + 1;
+    int16_t rowWidth = screenWidth + (useDisplayOffset ? displayOffsetX : 0);
+
+    int visibleItems = menuItemsVisible;
+    if (visibleItems > MAX_VISIBLE_ROWS) visibleItems = MAX_VISIBLE_ROWS;
+    if (visibleItems < 1) visibleItems = 1;
+    int selected = enumAdjuster->getIndex();
+    int optionCount = enumAdjuster->getOptionCount();
+    int first = (selected / visibleItems) * visibleItems;
+
+    for (int i = 0; i < visibleItems; i++) {
+        int option = first + i;
+        int16_t yPos = rowY[i];
+        int16_t leftX = 0;
+        int16_t indentedX = 10;
+        if (useDisplayOffset) {
+            yPos += displayOffsetY;
+            leftX += displayOffsetX;
+            indentedX += displayOffsetX;
+        }
+
+        // Rows past the last option are tracked too, so a shorter page clears them
+        uint32_t rowKey = hashMix(0, option);
+        if (option < optionCount) {
+            int16_t labelX = indentedX;
+            if (option == selected) {
+                display->setCursor(leftX, yPos);
+                display->print("> ");
+                labelX = display->tx;
+            }
+            const char* label = enumAdjuster->getOption(option);
+            drawLabel(labelX, yPos, label, standardFont, standardMetrics);
+            rowKey = hashString(hashMix(rowKey, option == selected), label);
+        }
+        trackRegion(REGION_ROW_FIRST + i, rowKey, 0, yPos - rowAscent, rowWidth, rowHeight);
+    }
 }
 
 void ESP32_MenuSystem::setError(int code, const char* message) {
     errorCode = code;
     strncpy(errorMessage, message, sizeof(errorMessage) - 1);
     errorMessage[sizeof(errorMessage) - 1] = '\0';
+    needsRedraw = true;
 }
 
 void ESP32_MenuSystem::clearError() {
     errorCode = 0;
     errorMessage[0] = '\0';
+    needsRedraw = true;
 }
 
 void ESP32_MenuSystem::displayError() {
-    display->clearBuffer();
+    renderFrame(&ESP32_MenuSystem::drawError);
+}
+
+void ESP32_MenuSystem::drawError() {
+    beginScreen(SCREEN_ERROR);
+    frameFullFlush = true;
+
     display->setFont(titleFont);  // Use title font
     
     display->setCursor(0, 20);
@@ -1018,33 +3927,71 @@ void ESP32_MenuSystem::displayError() {
     
     display->setCursor(0, 50);
     display->print("Press button to continue");
-    
-    display->sendBuffer();
 }
 
 void ESP32_MenuSystem::update() {
-    // Handle input based on mode
-    if (inputMode == INPUT_BUTTONS) {
-        checkButtons();
-    } else if (inputMode == INPUT_ENCODER) {
-        handleEncoderMovement();
-        handleButtonPress();
+    // Poll less often while idle
+    unsigned long now = millis();
+    if (idleState != IDLE_ACTIVE && now - lastPoll < idlePollInterval) return;
+    lastPoll = now;
+
+    // Input changes the state the render task draws from
+    lockState();
+
+    #ifdef MENU_ENABLE_STATS
+    uint32_t inputStart = MENU_STATS_CYCLES();
+    unsigned long inputMicros = micros();
+    bool wasDirty = needsRedraw;
+    pollInput();
+    addSample(TIMING_INPUT, MENU_STATS_CYCLES() - inputStart);
+    if (needsRedraw && !wasDirty) {
+        // Queued edges (possibly drained by an earlier update() while they
+        // were being debounced) waited for this one: time from the oldest
+        if (inputDrained) {
+            long waitedMs = (long)(now - oldestInputMillis);
+            if (waitedMs > 0) inputMicros -= (unsigned long)waitedMs * 1000UL;
+            inputDrained = false;
+        }
+        noteInput(inputMicros);
+    } else if (inputDrained) {
+        // Edges that settled without acting (bounce) must not date later input
+        bool settled = true;
+        for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+            if (buttons[id].pin >= 0 && buttons[id].state != buttons[id].lastState) settled = false;
+        }
+        if (settled) inputDrained = false;
     }
+    #else
+    pollInput();
+    #endif
     
-    // Display the current menu
+    updateIdleState(millis());
+
+    // Next part of a chunked flush, then redraw if anything changed
+    if (flushActive) {
+        continueFlush();
+    }
     displayMenu();
-    
-    // Add any other periodic updates here
-    unsigned long currentMillis = millis();
-    if (currentMillis - previousMillis >= interval) {
-        previousMillis = currentMillis;
-        // Add any code that needs to run on the interval
+    prefetchListRows();
+    if (persist && persist->count > 0) {
+        updatePersistence();
+    }
+
+    unlockState();
+
+    if (idleState == IDLE_DISPLAY_OFF && lightSleepWhenOff) {
+        lightSleep();
     }
 }
 
 int ESP32_MenuSystem::findMenuById(int id) {
-    for (int i = 0; i < menuCount; i++) {
-        if (menus[i].id == id) {
+    if (id >= 0 && id < model->menuIdIndexSize && model->menuIdIndex[id] >= 0) {
+        return model->menuIdIndex[id];
+    }
+
+    // Ids too large for the table
+    for (int i = 0; i < model->menuCount; i++) {
+        if (model->menus[i].id == id) {
             return i;
         }
     }
@@ -1052,21 +3999,24 @@ int ESP32_MenuSystem::findMenuById(int id) {
 }
 
 Menu* ESP32_MenuSystem::getCurrentMenu() {
-    if (currentMenuIndex >= 0 && currentMenuIndex < menuCount) {
-        return &menus[currentMenuIndex];
+    if (currentMenuIndex >= 0 && currentMenuIndex < model->menuCount) {
+        return &model->menus[currentMenuIndex];
     }
     return nullptr;
 }
 
 int ESP32_MenuSystem::getCurrentMenuId() const {
     // Get the current menu
-    if (currentMenuIndex >= 0 && currentMenuIndex < menuCount) {
-        return menus[currentMenuIndex].id;
+    if (currentMenuIndex >= 0 && currentMenuIndex < model->menuCount) {
+        return model->menus[currentMenuIndex].id;
     }
     return -1;  // Return -1 if there's no valid current menu
 }
 
 void ESP32_MenuSystem::begin() {
+    // Pick the full or page buffer path to match the U8G2 constructor used
+    setRenderMode(renderMode);
+
     // Update layout based on actual font dimensions now that the display is ready
     updateLayoutForFonts();
     
@@ -1087,4 +4037,16 @@ void ESP32_MenuSystem::begin() {
             setScreenSize(screenWidth, screenHeight);
         }
     }
+
+    #ifdef MENU_ENABLE_GLYPH_CACHE
+    checkGlyphBuffer();
+    #endif
+
+    // Saved settings replace the defaults before the first frame
+    if (persist && persist->count > 0) {
+        loadSettings();
+    }
+
+    // Hand drawing over to the render task if one was requested
+    startRenderTask();
 }
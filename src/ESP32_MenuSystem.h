@@ -5,30 +5,111 @@
 #include <Arduino.h>
 #include <U8g2lib.h>
 #include <Wire.h>
-#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 
-// Detect which ESP32 variant we're using
+// Input backends compiled in. Set one or more as build flags (they must
+// reach the library's .cpp as well, e.g. PlatformIO build_flags) to build
+// only the code for your input device. With none set, all three backends
+// are built and picked by constructor.
+//   MENU_INPUT_BUTTONS        Up/down/ok buttons
+//   MENU_INPUT_ENCODER        Rotary encoder with push button
+//   MENU_INPUT_SINGLE_BUTTON  One button: short press moves, long press selects
+// MENU_INPUT_REMOTE adds the binary remote control channel (a Stream or
+// datagrams, see setRemoteControl()) next to whichever of these is built.
+// Like MENU_ENABLE_STATS, MENU_ENABLE_MIRROR and MENU_ENABLE_GLYPH_CACHE,
+// these flags only select the code in the .cpp: ESP32_MenuSystem has the
+// same members in every build, so a sketch compiled with other flags than
+// the library still agrees with it. Each feature's state sits behind a
+// pointer and is only allocated when the feature is first used, so a
+// feature that is left out or unused costs a pointer. Using a feature that
+// is not built in fails to link.
+#if !defined(MENU_INPUT_BUTTONS) && !defined(MENU_INPUT_ENCODER) && !defined(MENU_INPUT_SINGLE_BUTTON)
+  #define MENU_INPUT_BUTTONS
+  #define MENU_INPUT_ENCODER
+  #define MENU_INPUT_SINGLE_BUTTON
+#endif
+
+#if (defined(MENU_INPUT_BUTTONS) + defined(MENU_INPUT_ENCODER) + defined(MENU_INPUT_SINGLE_BUTTON)) == 1
+  #define MENU_INPUT_FIXED     // One backend: no runtime input mode
+#endif
+
+// Detect which ESP32 variant we're using (the encoder driver is only
+// included by the .cpp, with MENU_INPUT_ENCODER)
 #if defined(CONFIG_IDF_TARGET_ESP32) || defined(CONFIG_IDF_TARGET_ESP32S2) || defined(ESP32)
   #include <soc/soc_caps.h>
   #if SOC_PCNT_SUPPORTED
-    #include <ESP32Encoder.h>
     #define USE_ESP32_ENCODER
   #else
-    #include "InterruptEncoder.h"
     #define USE_INTERRUPT_ENCODER
   #endif
 #else
-  #include "InterruptEncoder.h"
   #define USE_INTERRUPT_ENCODER
 #endif
 
-#define MAX_MENU_ITEMS 16
-#define MAX_MENU_NAME_LENGTH 16
-#define MAX_MENU_DEPTH 32
+// Frame mirroring (setMirror()) is compiled in with MENU_ENABLE_MIRROR.
+// A mirrored frame is
+//   MIRROR_SYNC, flags, tile columns, tile rows, spans..., MIRROR_END
+// and each span is: tile row, first tile, tile count, then PackBits data
+// decoding to count * 8 buffer bytes (U8g2 tile layout). With
+// MIRROR_FLAG_XOR the bytes are XORed against the previous frame.
+#define MIRROR_SYNC 0x5A
+#define MIRROR_END 0xFF
+#define MIRROR_FLAG_XOR 0x01
+
+// Performance counters (getStats()) are off by default; define
+// MENU_ENABLE_STATS as a build flag to compile them in.
+
+#define MAX_MENU_NAME_LENGTH 16    // Bool adjuster labels
+#define MAX_MENU_ITEMS 16          // Legacy: the old per-menu item limit, no longer enforced
+#define MAX_MENU_DEPTH 32          // Levels goBack() can return through
+#ifndef MENU_ARENA_SIZE
+// Bytes for menus, items and names (see useArena()). The default holds
+// what the fixed tables did: 32 menus of 16 items with 15 char names
+// (about 26 KB on ESP32).
+#define MENU_ARENA_SIZE (32 * (sizeof(Menu) + 16 + 16 * (sizeof(MenuItem) + 16)) + 64)
+#endif
+#define MAX_VISIBLE_ROWS 16        // Item rows laid out (and tracked) per screen
+#define MAX_DISPLAY_TILE_ROWS 16   // Tallest panel (in 8px tile rows) that supports partial updates
+#define MENU_VALUE_TEXT_LENGTH 16  // Formatted value + unit shown in a menu row
+#define MENU_INPUT_QUEUE_SIZE 16   // Button edges buffered for interrupt input (power of two)
+#define MAX_ENCODER_ACCEL_STEPS 4  // Entries in the encoder acceleration curve
+#define MENU_STATS_WINDOW 32       // Samples per timing kept for getStats()
+#define MENU_ANIMATION_FRAME_MS 16 // Animation frame period without setFrameRate()
+#define MENU_LIST_CACHE_ROWS 24    // Data source rows kept in RAM (visible + prefetch)
+#define MENU_LIST_PREFETCH 4       // Data source rows fetched above and below the view
+#define MENU_LIST_TEXT_LENGTH 24   // Chars per data source row
+#define MAX_SCREEN_INFO_REGIONS 4  // Screen info regions with their own refresh (all menus)
+#define MAX_PERSISTED_VALUES 16    // Adjusters saved to NVS with persistValue()
+#define MENU_REMOTE_FRAME_SIZE 64  // Max payload bytes of a remote control frame
+#define MENU_REMOTE_MAX_VALUES 6   // Values reported back per remote frame
+#ifndef MENU_GLYPH_CACHE_SLOTS
+#define MENU_GLYPH_CACHE_SLOTS 8   // Labels kept as bitmaps (MENU_ENABLE_GLYPH_CACHE)
+#endif
+#ifndef MENU_GLYPH_CACHE_BYTES
+#define MENU_GLYPH_CACHE_BYTES 256 // Bitmap bytes per label; larger labels are printed
+#endif
 
 #define ADJUSTER_TYPE_FLOAT 0
 #define ADJUSTER_TYPE_INT 1
 #define ADJUSTER_TYPE_BOOL 2
+#define ADJUSTER_TYPE_ENUM 3
+#define ADJUSTER_TYPE_FIXED 4
+
+// Storage tag of a value adjuster. The built-in kinds keep their value
+// pointer, range and format inline in ValueAdjuster, and the menu reads
+// and steps them with a switch, so they are final: an overridden
+// setValue() would be bypassed. Custom subclasses of ValueAdjuster go
+// through the virtual interface.
+enum AdjusterKind {
+    ADJUSTER_KIND_CUSTOM,
+    ADJUSTER_KIND_FLOAT,
+    ADJUSTER_KIND_INT,
+    ADJUSTER_KIND_BOOL,
+    ADJUSTER_KIND_ENUM,
+    ADJUSTER_KIND_FIXED
+};
 
 // Button trigger types
 enum ButtonTriggerType {
@@ -44,26 +125,134 @@ enum ButtonID {
     BUTTON_ID_ENCODER
 };
 
+// Debounce algorithm, selectable per button
+enum DebounceMode {
+    DEBOUNCE_TIME,        // Accept a level once it has been stable for the debounce delay
+    DEBOUNCE_INTEGRATOR   // Integrate pressed/released time; bounces cancel out
+};
+
+// One point of the encoder acceleration curve: at or above minRate
+// (encoder steps per second) each step counts as multiplier increments
+struct EncoderAccelerationStep {
+    uint16_t minRate;
+    uint16_t multiplier;
+};
+
+// One timing over the last MENU_STATS_WINDOW samples
+struct MenuTiming {
+    uint32_t last;
+    uint32_t avg;
+    uint32_t p99;
+    uint32_t max;
+    uint16_t samples;     // Samples in the window
+};
+
+// Snapshot returned by getStats(). Section timings are in CPU cycles
+// (divide by cpuMhz for microseconds), latency is in microseconds.
+struct MenuStats {
+    MenuTiming input;     // Polling and acting on input in update()
+    MenuTiming draw;      // Drawing a frame (and sending it, in page buffer mode)
+    MenuTiming flush;     // sendBuffer() / updateDisplayArea()
+    MenuTiming latency;   // Input acted on -> frame sent
+    uint32_t framesRendered;
+    uint32_t framesSkipped;   // update() passes with nothing to redraw
+    uint32_t cpuMhz;
+};
+
 // Input mode options
 enum InputMode {
-    INPUT_BUTTONS,     // Traditional up/down/ok buttons
-    INPUT_ENCODER      // Rotary encoder with button
+    INPUT_BUTTONS,       // Traditional up/down/ok buttons
+    INPUT_ENCODER,       // Rotary encoder with button
+    INPUT_SINGLE_BUTTON  // One button (uses the BUTTON_ID_OK slot)
+};
+
+// Remote control protocol (MENU_INPUT_REMOTE). Frames in both directions are
+//   REMOTE_SYNC, payload length, payload, XOR of the payload bytes
+// A command frame holds any number of commands, applied in order before
+// the next frame is drawn. Multi-byte fields are little endian; values
+// are int32 for int, enum and bool items and float32 bits otherwise.
+#define REMOTE_SYNC 0xA5
+enum RemoteCommand {
+    REMOTE_UP = 0x01,
+    REMOTE_DOWN = 0x02,
+    REMOTE_SELECT = 0x03,
+    REMOTE_BACK = 0x04,        // Leave value adjusting / an error, else goBack()
+    REMOTE_OPEN_MENU = 0x05,   // int16 menu id
+    REMOTE_SET_VALUE = 0x06,   // int16 menu id, uint16 item, 4-byte value
+    REMOTE_GET_VALUE = 0x07,   // int16 menu id, uint16 item
+    REMOTE_GET_STATE = 0x08
+};
+// Each command frame is answered with one frame listing what changed
+enum RemoteReply {
+    REMOTE_STATE = 0x81,       // int16 menu id, int16 cursor, uint8 RemoteMode
+    REMOTE_VALUE = 0x82,       // int16 menu id, uint16 item, 4-byte value
+    REMOTE_ERROR = 0x83        // uint8 offset of the failed command (0xFF: bad frame)
+};
+enum RemoteMode {
+    REMOTE_MODE_MENU,
+    REMOTE_MODE_ADJUSTING,
+    REMOTE_MODE_ERROR
 };
 
+// Idle policy states (see setIdleTimeouts())
+enum IdleState {
+    IDLE_ACTIVE,        // Normal operation
+    IDLE_DIMMED,        // Contrast lowered, timed refreshes paused
+    IDLE_DISPLAY_OFF    // Panel in power save, nothing is drawn
+};
+
+// Screen refresh policy used by displayMenu()
+enum RefreshMode {
+    REFRESH_ON_CHANGE,   // Redraw only when the screen has been invalidated
+    REFRESH_TIMED,       // Also redraw menus with a screen info callback every refresh interval
+    REFRESH_CONTINUOUS   // Redraw on every call (legacy behaviour)
+};
+
+// Frame buffer handling
+enum RenderMode {
+    RENDER_AUTO,         // Detect from the U8G2 object in begin()
+    RENDER_FULL_BUFFER,  // _F constructors: clearBuffer()/sendBuffer()
+    RENDER_PAGE_BUFFER   // _1/_2 constructors: firstPage()/nextPage() loop
+};
+
+// Build-time override, e.g. -DMENU_DEFAULT_RENDER_MODE=RENDER_PAGE_BUFFER
+#ifndef MENU_DEFAULT_RENDER_MODE
+#define MENU_DEFAULT_RENDER_MODE RENDER_AUTO
+#endif
+
 // Forward declarations
 class Menu;
+struct MenuModel;
 class ValueAdjuster;
+class ValueEditor;
+class ESP32_MenuSystem;
 
 // Forward declare the callback type
 typedef void (*ScreenInfoCallback)();
 typedef void (*SimpleMenuFunction)();
+typedef void (*ContextMenuFunction)(void* context);
 
-// Menu callback base class
+// Menu callback base class. Callbacks passed to addMenuItem() stay owned
+// by the caller; the menu system never deletes them.
 class MenuCallback {
 public:
+    virtual ~MenuCallback() {}
     virtual void execute() = 0;
 };
 
+// Entries supplied by the application, for lists too long to store as
+// menu items (scan results, log lines, sensor IDs). Only the rows on
+// screen and a few around them are requested; see addListMenu().
+class MenuDataSource {
+public:
+    virtual ~MenuDataSource() {}
+    virtual int count() = 0;
+    // Write the label of entry `index` into buffer (size includes the terminator)
+    virtual void getItem(int index, char* buffer, size_t size) = 0;
+    // OK on an entry: return a menu id to open, or -1 to stay
+    virtual int select(int index) { return -1; }
+};
+
 class FunctionCallback : public MenuCallback {
     private:
         SimpleMenuFunction function;
@@ -78,58 +267,93 @@ class FunctionCallback : public MenuCallback {
         }
     };
 
-// Menu item class
+// Menu item class. Items can be declared as constant tables, which the
+// compiler places in flash:
+//   constexpr MenuItem settingsItems[] = {
+//       MenuItem("Brightness", -1, nullptr, &brightnessAdjuster),
+//       MenuItem("Back", MENU_MAIN),
+//   };
 class MenuItem {
     public:
-        char name[MAX_MENU_NAME_LENGTH];
+        const char* name;
         int nextMenuId;
         MenuCallback* callback;
         ValueAdjuster* valueAdjuster;  // For items that adjust values
+        ValueEditor* editor;           // Edit screen, nullptr = built-in for the adjuster
+        // Actions stored inline (no allocation)
+        SimpleMenuFunction function;
+        ContextMenuFunction contextFunction;
+        void* context;
         
-        MenuItem() : nextMenuId(-1), callback(nullptr), valueAdjuster(nullptr) {
-            name[0] = '\0';
-        }
+        constexpr MenuItem() : name(""), nextMenuId(-1), callback(nullptr), valueAdjuster(nullptr),
+                               editor(nullptr), function(nullptr), contextFunction(nullptr), context(nullptr) {}
+        
+        constexpr MenuItem(const char* itemName, int nextId = -1, MenuCallback* cb = nullptr, ValueAdjuster* adjuster = nullptr) 
+            : name(itemName), nextMenuId(nextId), callback(cb), valueAdjuster(adjuster), editor(nullptr),
+              function(nullptr), contextFunction(nullptr), context(nullptr) {}
+        
+        constexpr MenuItem(const char* itemName, ValueAdjuster* adjuster, ValueEditor* valueEditor)
+            : name(itemName), nextMenuId(-1), callback(nullptr), valueAdjuster(adjuster), editor(valueEditor),
+              function(nullptr), contextFunction(nullptr), context(nullptr) {}
         
-        MenuItem(const char* itemName, int nextId = -1, MenuCallback* cb = nullptr, ValueAdjuster* adjuster = nullptr) 
-            : nextMenuId(nextId), callback(nullptr), valueAdjuster(adjuster) {
-            strncpy(name, itemName, MAX_MENU_NAME_LENGTH - 1);
-            name[MAX_MENU_NAME_LENGTH - 1] = '\0';
-            callback = cb;
+        constexpr MenuItem(const char* itemName, SimpleMenuFunction fn, int nextId = -1)
+            : name(itemName), nextMenuId(nextId), callback(nullptr), valueAdjuster(nullptr), editor(nullptr),
+              function(fn), contextFunction(nullptr), context(nullptr) {}
+        
+        constexpr MenuItem(const char* itemName, ContextMenuFunction fn, void* ctx, int nextId = -1)
+            : name(itemName), nextMenuId(nextId), callback(nullptr), valueAdjuster(nullptr), editor(nullptr),
+              function(nullptr), contextFunction(fn), context(ctx) {}
+        
+        void execute() const {
+            if (function) function();
+            if (contextFunction) contextFunction(context);
+            if (callback) callback->execute();
         }
     };
 
-// Menu class
+// A menu declared at compile time, for ESP32_MenuSystem::addMenuTree()
+struct MenuDefinition {
+    const char* title;
+    const MenuItem* items;
+    int itemCount;
+    int id;              // -1 = its index, as for addMenu()
+};
+
+// Menu class: the items are either a constant table (flash), a block
+// in the menu system's arena or a data source
 class Menu {
 public:
-    char title[MAX_MENU_NAME_LENGTH];
-    MenuItem items[MAX_MENU_ITEMS];
+    const char* title;
+    const MenuItem* items;
     int itemCount;
     int id;
+    uint16_t itemCapacity;  // Arena block size in items, 0 for constant menus
+    MenuDataSource* dataSource;  // Entries come from the application instead of items
     
     // Add screen info callback
     ScreenInfoCallback screenInfoCallback;
     bool hasScreenInfo;
 
     int maxVisibleItems;  // Maximum number of items to display at once (0 = auto/fit screen)
+    MenuModel* owner;     // Tree holding the menu, set when it is added
    
-    Menu() : itemCount(0), id(-1), screenInfoCallback(nullptr), 
-             hasScreenInfo(false), maxVisibleItems(0) {  // Default is 0 (auto)
-        title[0] = '\0';
-    }
-    
-    Menu(const char* menuTitle, int menuId) : itemCount(0), id(menuId),
-             screenInfoCallback(nullptr), hasScreenInfo(false),
-             maxVisibleItems(0) {  // Default is 0 (auto)
-        strncpy(title, menuTitle, MAX_MENU_NAME_LENGTH - 1);
-        title[MAX_MENU_NAME_LENGTH - 1] = '\0';
-    }
+    Menu() : title(""), items(nullptr), itemCount(0), id(-1), itemCapacity(0),
+             dataSource(nullptr), screenInfoCallback(nullptr), hasScreenInfo(false),
+             maxVisibleItems(0), owner(nullptr) {}  // Default is 0 (auto)
     
-    void addItem(const char* name, int nextMenuId = -1, MenuCallback* callback = nullptr, ValueAdjuster* adjuster = nullptr) {
-        if (itemCount < MAX_MENU_ITEMS) {
-            items[itemCount] = MenuItem(name, nextMenuId, callback, adjuster);
-            itemCount++;
-        }
-    }
+    Menu(const char* menuTitle, int menuId, const MenuItem* menuItems = nullptr, int count = 0)
+           : title(menuTitle), items(menuItems), itemCount(count), id(menuId),
+             itemCapacity(0), dataSource(nullptr), screenInfoCallback(nullptr), hasScreenInfo(false),
+             maxVisibleItems(0), owner(nullptr) {}  // Default is 0 (auto)
+
+    bool isConstant() const { return items != nullptr && itemCapacity == 0; }
+    int getItemCount() const { return dataSource ? dataSource->count() : itemCount; }
+
+    // Old API: adds to the arena of the menu system holding this menu (a
+    // menu that was never added has no arena and ignores it)
+    [[deprecated("use ESP32_MenuSystem::addMenuItem(menuIndex, ...)")]]
+    void addItem(const char* name, int nextMenuId = -1, MenuCallback* callback = nullptr,
+                 ValueAdjuster* adjuster = nullptr);
 
     void setMaxVisibleItems(int max) {
         maxVisibleItems = max;
@@ -142,14 +366,17 @@ public:
     }
 };
 
-// Value adjuster interface classes remain unchanged...
+// Value adjuster interface. Derive from it for custom value types.
 class ValueAdjuster {
     public:
         // Type identifiers
         static const int TYPE_FLOAT = 0;
         static const int TYPE_INT = 1;
         static const int TYPE_BOOL = 2;
+        static const int TYPE_ENUM = 3;
+        static const int TYPE_FIXED = 4;
         
+        virtual ~ValueAdjuster() {}
         virtual float getValue() = 0;
         virtual void setValue(float newValue) = 0;
         virtual float getIncrement() = 0;
@@ -160,115 +387,178 @@ class ValueAdjuster {
         
         // Add type identification method
         virtual int getType() const { return TYPE_FLOAT; } // Default type
+
+        AdjusterKind getKind() const { return (AdjusterKind)kind; }
+
+    protected:
+        explicit ValueAdjuster(AdjusterKind adjusterKind = ADJUSTER_KIND_CUSTOM)
+            : kind(adjusterKind), decimals(0), wrap(false), revision(0), unit(""), target(nullptr) {
+            range.i.min = range.i.max = range.i.step = 0;
+        }
+
+        void markChanged() { revision++; }
+
+        // Inline description of the built-in kinds (unused for custom ones)
+        uint8_t kind;
+        uint8_t decimals;
+        bool wrap;
+        // Bumped by every built-in setValue(), so the menus showing or
+        // saving this value notice changes made outside their own input
+        uint8_t revision;
+        const char* unit;
+        void* target;               // float*, int* (int and enum index), int32_t* (fixed) or bool*
+        union {
+            struct { float min, max, step; } f;
+            struct { int32_t min, max, step; } i;
+        } range;
+
+        // Clamp or wrap a stepped value into [min, max]
+        template <typename T>
+        static T limit(T value, T min, T max, bool wrapAround) {
+            if (wrapAround) {
+                // Apply limits with wrapping
+                if (value > max) return min;
+                if (value < min) return max;
+                return value;
+            }
+            // Apply limits without wrapping (original behavior)
+            if (value < min) return min;
+            if (value > max) return max;
+            return value;
+        }
+
+        friend class ESP32_MenuSystem;
     };
     
 // Implementation of a float value adjuster
-class FloatValueAdjuster : public ValueAdjuster {
-    private:
-    float* valuePtr;
-    float increment;
-    float minValue;
-    float maxValue;
-    int decimalPlaces;
-    const char* unit;
-    bool wrapAround; 
-    
+class FloatValueAdjuster final : public ValueAdjuster {
 public:
     FloatValueAdjuster(float* value, float inc, float min, float max, 
                       int decimals = 1, const char* valueUnit = "", 
                       bool wrap = true) // Added wrap parameter
-        : valuePtr(value), increment(inc), minValue(min), maxValue(max),
-          decimalPlaces(decimals), unit(valueUnit), wrapAround(wrap) {}
+        : ValueAdjuster(ADJUSTER_KIND_FLOAT) {
+        target = value;
+        range.f.min = min;
+        range.f.max = max;
+        range.f.step = inc;
+        this->decimals = (decimals < 0) ? 0 : (uint8_t)decimals;
+        unit = valueUnit;
+        this->wrap = wrap;
+    }
 
     int getType() const override { return TYPE_FLOAT; }
     
-    float getValue() override { return *valuePtr; }
-    
+    float getValue() override { return *static_cast<float*>(target); }
     
     void setValue(float newValue) override {
-        if (wrapAround) {
-            // Apply limits with wrapping
-            if (newValue > maxValue) {
-                newValue = minValue;
-            } else if (newValue < minValue) {
-                newValue = maxValue;
-            }
-        } else {
-            // Apply limits without wrapping (original behavior)
-            if (newValue < minValue) newValue = minValue;
-            if (newValue > maxValue) newValue = maxValue;
-        }
-        *valuePtr = newValue;
+        *static_cast<float*>(target) = limit(newValue, range.f.min, range.f.max, wrap);
+        markChanged();
     }
     
-    float getIncrement() override { return increment; }
-    float getMin() override { return minValue; }
-    float getMax() override { return maxValue; }
+    float getIncrement() override { return range.f.step; }
+    float getMin() override { return range.f.min; }
+    float getMax() override { return range.f.max; }
     const char* getUnit() override { return unit; }
-    int getDecimalPlaces() override { return decimalPlaces; }
+    int getDecimalPlaces() override { return decimals; }
 };
 
 // Implementation of an integer value adjuster
-class IntValueAdjuster : public ValueAdjuster {
-    private:
-        int* valuePtr;
-        int increment;
-        int minValue;
-        int maxValue;
-        const char* unit;
-        bool wrapAround;
-        
+class IntValueAdjuster final : public ValueAdjuster {
     public:
     IntValueAdjuster(int* value, int inc, int min, int max, 
         const char* valueUnit = "", bool wrap = true) 
-        : valuePtr(value), increment(inc), minValue(min), maxValue(max),
-            unit(valueUnit), wrapAround(wrap) {}
+        : ValueAdjuster(ADJUSTER_KIND_INT) {
+            target = value;
+            range.i.min = min;
+            range.i.max = max;
+            range.i.step = inc;
+            unit = valueUnit;
+            this->wrap = wrap;
+        }
 
         int getType() const override { return TYPE_INT; }
         
-        float getValue() override { return static_cast<float>(*valuePtr); }
+        float getValue() override { return static_cast<float>(*static_cast<int*>(target)); }
         
         void setValue(float newValue) override {
             // Convert to int
-            int intValue = static_cast<int>(newValue);
-            
-            if (wrapAround) {
-                // Apply limits with wrapping
-                if (intValue > maxValue) {
-                    intValue = minValue; // Wrap to minimum value
-                } else if (intValue < minValue) {
-                    intValue = maxValue; // Wrap to maximum value 
-                }
-            } else {
-                // Apply limits without wrapping (original behavior)
-                if (intValue < minValue) intValue = minValue;
-                if (intValue > maxValue) intValue = maxValue;
-            }
-            
-            *valuePtr = intValue;
+            *static_cast<int*>(target) = limit<int32_t>(static_cast<int32_t>(newValue),
+                                                        range.i.min, range.i.max, wrap);
+            markChanged();
         }
-        float getIncrement() override { return static_cast<float>(increment); }
-        float getMin() override { return static_cast<float>(minValue); }
-        float getMax() override { return static_cast<float>(maxValue); }
+        float getIncrement() override { return static_cast<float>(range.i.step); }
+        float getMin() override { return static_cast<float>(range.i.min); }
+        float getMax() override { return static_cast<float>(range.i.max); }
         const char* getUnit() override { return unit; }
         int getDecimalPlaces() override { return 0; } // Always 0 for integers
     };
 
+// Fixed-point value kept as a scaled integer: with 2 decimals, 1234 is
+// shown as "12.34". Stepped, limited and formatted in integers, so it
+// stays exact over the whole int32_t range (floats lose steps above 2^24).
+class FixedValueAdjuster final : public ValueAdjuster {
+    public:
+        FixedValueAdjuster(int32_t* raw, int32_t inc, int32_t min, int32_t max, uint8_t decimals,
+                           const char* valueUnit = "", bool wrap = true)
+            : ValueAdjuster(ADJUSTER_KIND_FIXED) {
+            target = raw;
+            range.i.min = min;
+            range.i.max = max;
+            range.i.step = inc;
+            this->decimals = (decimals > 9) ? 9 : decimals;
+            unit = valueUnit;
+            this->wrap = wrap;
+        }
+
+        int getType() const override { return TYPE_FIXED; }
+
+        // The float interface is for custom code only; the menu uses the raw value
+        float getValue() override { return static_cast<float>(getRaw()) / scale(); }
+
+        void setValue(float newValue) override {
+            float scaled = newValue * scale();
+            scaled += (scaled < 0.0f) ? -0.5f : 0.5f;
+            if (scaled > 2147483520.0f) scaled = 2147483520.0f;   // Largest float below 2^31
+            if (scaled < -2147483648.0f) scaled = -2147483648.0f;
+            setRaw(static_cast<int32_t>(scaled));
+        }
+        float getIncrement() override { return static_cast<float>(range.i.step) / scale(); }
+        float getMin() override { return static_cast<float>(range.i.min) / scale(); }
+        float getMax() override { return static_cast<float>(range.i.max) / scale(); }
+        const char* getUnit() override { return unit; }
+        int getDecimalPlaces() override { return decimals; }
+
+        int32_t getRaw() const { return *static_cast<int32_t*>(target); }
+        void setRaw(int32_t raw) {
+            *static_cast<int32_t*>(target) = limit(raw, range.i.min, range.i.max, wrap);
+            markChanged();
+        }
+
+    private:
+        float scale() const {
+            float factor = 1.0f;
+            for (uint8_t i = 0; i < decimals; i++) factor *= 10.0f;
+            return factor;
+        }
+    };
+
 // Implementation of a boolean value adjuster with custom text labels
-class BoolValueAdjuster : public ValueAdjuster {
+class BoolValueAdjuster final : public ValueAdjuster {
     private:
-        bool* valuePtr;         // Points to the actual stored boolean value
         bool tempValue;         // Temporary value for selection
         char trueLabel[MAX_MENU_NAME_LENGTH];
         char falseLabel[MAX_MENU_NAME_LENGTH];
         char description[MAX_MENU_NAME_LENGTH];
-        int adjusterType;       // Simple type identifier
+
+        bool& stored() const { return *static_cast<bool*>(target); }
         
     public:
         BoolValueAdjuster(bool* value, const char* trueText = "On", const char* falseText = "Off", 
-                         const char* desc = "") : valuePtr(value), tempValue(*value) {
-            // Set type explicitly
-            adjusterType = ADJUSTER_TYPE_BOOL;
+                         const char* desc = "") : ValueAdjuster(ADJUSTER_KIND_BOOL), tempValue(*value) {
+            target = value;
+            range.i.min = 0;
+            range.i.max = 1;
+            range.i.step = 1;
             
             // Copy labels with length protection
             strncpy(trueLabel, trueText, MAX_MENU_NAME_LENGTH - 1);
@@ -282,13 +572,14 @@ class BoolValueAdjuster : public ValueAdjuster {
         }
         
         float getValue() override { 
-            return *valuePtr ? 1.0f : 0.0f; 
+            return stored() ? 1.0f : 0.0f; 
         }
         
         void setValue(float newValue) override {
             // For boolean, just toggle the value regardless of the input
             // This ensures it always cycles between true and false
-            *valuePtr = !(*valuePtr);
+            stored() = !stored();
+            markChanged();
         }
         
         float getIncrement() override { return 1.0f; }
@@ -298,30 +589,174 @@ class BoolValueAdjuster : public ValueAdjuster {
         int getDecimalPlaces() override { return 0; }
         
         // Type identification - override the getType method from ValueAdjuster
-        int getType() const override { return adjusterType; }
+        int getType() const override { return ADJUSTER_TYPE_BOOL; }
         
         // Specific methods for BoolValueAdjuster
         const char* getTrueLabel() const { return trueLabel; }
         const char* getFalseLabel() const { return falseLabel; }
         const char* getDescription() const { return description; }
-        const char* getCurrentLabel() const { return *valuePtr ? trueLabel : falseLabel; }
+        const char* getCurrentLabel() const { return stored() ? trueLabel : falseLabel; }
         
-        bool isTrue() const { return *valuePtr; }
+        bool isTrue() const { return stored(); }
         
         // Methods for temporary selection
         void setTempValue(bool value) { tempValue = value; }
         bool getTempValue() const { return tempValue; }
-        void applyTempValue() { *valuePtr = tempValue; }
+        void applyTempValue() { stored() = tempValue; markChanged(); }
         const char* getTempLabel() const { return tempValue ? trueLabel : falseLabel; }
     };
 
+// Choice between named options; the value is the option index
+class EnumValueAdjuster final : public ValueAdjuster {
+    private:
+        const char* const* options;
+        
+    public:
+        EnumValueAdjuster(int* index, const char* const* optionLabels, int optionCount, bool wrap = true)
+            : ValueAdjuster(ADJUSTER_KIND_ENUM), options(optionLabels) {
+            target = index;
+            range.i.min = 0;
+            range.i.max = (optionCount > 0) ? optionCount - 1 : 0;
+            range.i.step = 1;
+            this->wrap = wrap;
+        }
+        
+        int getType() const override { return ADJUSTER_TYPE_ENUM; }
+        
+        float getValue() override { return static_cast<float>(*static_cast<int*>(target)); }
+        
+        void setValue(float newValue) override {
+            *static_cast<int*>(target) = limit<int32_t>(static_cast<int32_t>(newValue),
+                                                        range.i.min, range.i.max, wrap);
+            markChanged();
+        }
+        
+        float getIncrement() override { return 1.0f; }
+        float getMin() override { return 0.0f; }
+        float getMax() override { return static_cast<float>(range.i.max); }
+        const char* getUnit() override { return ""; }
+        int getDecimalPlaces() override { return 0; }
+        
+        int getIndex() const { return *static_cast<int*>(target); }
+        int getOptionCount() const { return range.i.max + 1; }
+        const char* getOption(int index) const {
+            return (options && index >= 0 && index <= range.i.max) ? options[index] : "";
+        }
+        const char* getCurrentOption() const { return getOption(getIndex()); }
+    };
+
+// Edit screen of a value item. The editor is picked once when value
+// adjustment starts (the item's own, else the built-in one for the
+// adjuster's kind) and gets every input event and frame until it ends,
+// so a new value type needs an editor, not changes to the input code.
+// Built-in: value and slider (float, int, fixed, custom adjusters), a
+// pending On/Off choice (bool) and an option list (enum).
+class ValueEditor {
+    public:
+        virtual ~ValueEditor() {}
+        // Adjustment starts, or the value was set from outside (remote)
+        virtual void begin(ValueAdjuster* adjuster) {}
+        // UP / DOWN, encoder detents and hold-to-repeat. steps is signed,
+        // and includes encoder acceleration and the repeat ramp if
+        // accelerates() is true.
+        virtual void step(ValueAdjuster* adjuster, long steps) = 0;
+        virtual bool accelerates() const { return true; }
+        // Single button short press. There is only one direction, so a
+        // choice between two ends can toggle instead.
+        virtual void cycle(ValueAdjuster* adjuster, long steps) { step(adjuster, steps); }
+        // OK: true leaves adjustment; false stays (e.g. to the next field)
+        virtual bool confirm(ValueAdjuster* adjuster) { return true; }
+        // Draw the screen into the cleared buffer with menu.getDisplay().
+        // Custom editor frames are always sent whole.
+        virtual void draw(ESP32_MenuSystem& menu, ValueAdjuster* adjuster) = 0;
+    };
+
+// Bump allocator over one buffer. Growable blocks (menu and item arrays)
+// are taken from the front and extended in place while they are the last
+// block; strings are packed from the back. Nothing is freed individually.
+class MenuArena {
+public:
+    MenuArena() : base(nullptr), size(0), front(0), back(0), owned(false),
+                  freeList(nullptr), freeBytes(0) {}
+    ~MenuArena() { release(); }
+    MenuArena(const MenuArena&) = delete;
+    MenuArena& operator=(const MenuArena&) = delete;
+
+    bool allocate(size_t bytes);             // Heap buffer owned by the arena
+    void use(uint8_t* buffer, size_t bytes); // Caller's buffer (e.g. static)
+    void release();
+
+    // Resize a block to newSize bytes; nullptr when full. A block that
+    // cannot grow in place moves into a freed block or to the end, and its
+    // old space is freed for the next block that fits.
+    void* grow(void* block, size_t oldSize, size_t newSize);
+    const char* copyString(const char* text);
+
+    size_t used() const { return front + (size - back) - freeBytes; }
+    size_t capacity() const { return size; }
+
+private:
+    // Freed blocks, linked through their own first bytes (first fit)
+    struct FreeBlock {
+        size_t size;
+        FreeBlock* next;
+    };
+    void recycle(uint8_t* block, size_t bytes);
+    void* takeFree(size_t bytes);
+
+    uint8_t* base;
+    size_t size;
+    size_t front;   // End of the front (block) region
+    size_t back;    // Start of the back (string) region
+    bool owned;
+    FreeBlock* freeList;
+    size_t freeBytes;
+};
+
+// The menu tree: menus, runtime items and their names all live in the
+// arena. Each ESP32_MenuSystem is a view with its own display, layout,
+// cursor and frame state; views can share one tree (see shareMenus()).
+struct MenuModel {
+    MenuArena arena;
+    Menu* menus;
+    int menuCount;
+    int menuCapacity;
+    // Menu id -> index, grown in the arena to the largest id (ids above
+    // MAX_INDEXED_MENU_ID fall back to a scan)
+    int16_t* menuIdIndex;
+    int menuIdIndexSize;
+    uint32_t revision;             // Bumped when menus or items change, so every view redraws
+
+    MenuModel() : menus(nullptr), menuCount(0), menuCapacity(0),
+                  menuIdIndex(nullptr), menuIdIndexSize(0), revision(0) {}
+
+    // Add an item to a runtime menu of this tree; false when it can't
+    bool appendItem(Menu& menu, const MenuItem& item);
+};
+
 // Main menu system class with combined input support
 class ESP32_MenuSystem {
 private:
-    Menu menus[MAX_MENU_DEPTH];
-    int menuCount;
+    MenuModel ownModel;
+    MenuModel* model;              // ownModel, or the tree of the view shared with
+    uint32_t modelRevision;        // model->revision at last draw
+    int appendMenu(const Menu& menu);
+    bool appendMenuItem(int menuIndex, const MenuItem& item);
     int currentMenuIndex;
     int cursorPosition;
+    int scrollOffset;              // First item row shown in the list
+
+    void indexMenuId(int id, int menuIndex);
+
+    // Views goBack() returns to
+    struct NavigationEntry {
+        int16_t menuIndex;
+        int16_t cursorPosition;
+        int16_t scrollOffset;
+    };
+    NavigationEntry navigationStack[MAX_MENU_DEPTH];
+    uint8_t navigationDepth;
+    void enterMenu(int menuIndex);
 
     // Screen properties
     uint16_t screenWidth;  // Screen width in pixels
@@ -348,65 +783,364 @@ private:
     uint8_t getFontHeight(const uint8_t* font);
     uint8_t getFontWidth(const uint8_t* font);
     void updateLayoutForFonts();
+
+    // Layout cache: font metrics and row baselines, so drawing never has to
+    // switch fonts just to measure them
+    struct FontMetrics {
+        int8_t ascent;
+        int8_t descent;   // Negative, as reported by U8g2
+        uint8_t height;   // getMaxCharHeight()
+        uint8_t width;    // getMaxCharWidth()
+    };
+    FontMetrics standardMetrics;
+    FontMetrics titleMetrics;
+    FontMetrics valueMetrics;
+    bool fontMetricsValid;
+    int16_t rowY[MAX_VISIBLE_ROWS];   // Baseline of each visible item row (without offset)
+    // String width cache for value text: re-measured with getStrWidth() only
+    // when the text or the font changes. Item names and titles are drawn
+    // left-aligned and never need measuring.
+    struct TextWidthCache {
+        uint8_t fontGeneration;   // 0 = empty
+        uint16_t width;
+        char text[MENU_VALUE_TEXT_LENGTH];
+    };
+    uint8_t fontGeneration;                            // Bumped whenever fonts are re-measured
+    // Last formatted value text per row slot, keyed on adjuster and value,
+    // so unchanged rows skip formatting entirely
+    struct RowValueCache {
+        const ValueAdjuster* adjuster;
+        uint32_t valueKey;        // adjusterValueKey()
+        TextWidthCache text;      // Value + unit and its width
+    };
+    RowValueCache rowValueCache[MAX_VISIBLE_ROWS];     // Indexed by item index % MAX_VISIBLE_ROWS
+    TextWidthCache adjustValueWidth;                   // Value in the adjust screen (value font)
+    TextWidthCache adjustMaxWidth;                     // Max label in the adjust screen
+    // Row text of the data source list on screen, direct mapped by index;
+    // MENU_LIST_CACHE_ROWS rows allocated when a list is first shown
+    struct ListRowCache;
+    ListRowCache* listRows;
+
+    // Static labels (titles, item names, enum options) drawn through
+    // drawLabel(). With MENU_ENABLE_GLYPH_CACHE, a label printed into the
+    // full buffer is copied out as an XBM bitmap, and later frames draw it
+    // with drawXBM() instead of decoding its glyphs again. Entries are keyed
+    // on the text, font and font generation; the least recently used slot
+    // is replaced.
+    void drawLabel(int16_t x, int16_t y, const char* text, const uint8_t* font,
+                   const FontMetrics& metrics, bool capture = true);
+    // The slots are defined in the .cpp and allocated by begin()
+    struct GlyphCacheEntry;
+    GlyphCacheEntry* glyphCache;
+    uint32_t glyphClock;
+    bool glyphCapture;        // Buffer is in vertical tile layout (checked in begin())
+    void checkGlyphBuffer();
+    void captureLabel(GlyphCacheEntry& entry, int16_t x, int16_t top);
+    int listCacheMenu;                                 // Menu the rows belong to, -1 = none
+    const char* listRowText(const Menu& menu, int index);
+    void prefetchListRows();
+    uint16_t measureText(TextWidthCache& cache, const char* text);
+    void readFontMetrics(const uint8_t* font, FontMetrics& metrics);
+    void cacheFontMetrics();
+    void updateRowPositions();
     U8G2* display;
     
-    // Input mode
+    // Input mode: activeInput() (in the .cpp) is a constant when only one
+    // backend is compiled in, so the branches on it fold away
     InputMode inputMode;
+    InputMode activeInput() const;
+    void pollInput();
+
+    // Remote control: bytes are collected into frames; each complete frame
+    // is applied as one batch and answered with the state that changed.
+    // Defined in the .cpp and allocated by setRemoteControl() or the first
+    // handleRemoteData().
+    struct RemoteState;
+    RemoteState* remote;
+    RemoteState* remoteState();
+    void feedRemote(uint8_t byte, Print* reply);
+    void applyRemoteFrame(const uint8_t* payload, uint8_t length, Print* reply);
+    bool applyRemoteCommand(const uint8_t* args, uint8_t command);
+    const MenuItem* remoteItem(int menuId, uint16_t item, int16_t* menuIndex);
+    void addRemoteValue(int16_t menuIndex, int item);
+    static void sendRemoteFrame(Print* out, const uint8_t* payload, uint8_t length);
     
-    // Button pins and states (for INPUT_BUTTONS mode)
-    int buttonUpPin;
-    int buttonDownPin;
-    int buttonOkPin;
-    bool buttonUpState;
-    bool buttonDownState;
-    bool buttonOkState;
-    bool lastButtonUpState;
-    bool lastButtonDownState;
-    bool lastButtonOkState;
-    
-    // Button trigger types
-    ButtonTriggerType buttonUpTriggerType;
-    ButtonTriggerType buttonDownTriggerType;
-    ButtonTriggerType buttonOkTriggerType;
-    ButtonTriggerType encoderButtonTriggerType;
+    // Buttons indexed by ButtonID: UP/DOWN/OK in INPUT_BUTTONS mode and
+    // ENCODER in INPUT_ENCODER mode
+    static const uint8_t BUTTON_COUNT = 4;
+    struct ButtonInput {
+        ESP32_MenuSystem* owner;    // For the GPIO interrupt handler
+        int pin;                    // -1 when not used in this mode
+        ButtonTriggerType trigger;
+        bool state;                 // Debounced state (true = pressed)
+        bool lastState;             // Last raw reading
+        DebounceMode debounceMode;
+        unsigned long debounceDelay;
+        unsigned long lastChange;   // DEBOUNCE_TIME: time of the last raw change
+        unsigned long lastSample;   // DEBOUNCE_INTEGRATOR: time of the last integration
+        unsigned long integral;     // DEBOUNCE_INTEGRATOR: 0..debounceDelay
+        unsigned long pressedAt;    // Time of the last debounced press
+        unsigned long nextRepeat;   // Hold time of the next auto-repeat
+        bool longPressFired;        // Single button: the hold already acted
+        bool wakePress;             // Press only woke the display; ignored until released
+    };
+    ButtonInput buttons[BUTTON_COUNT];
+    bool readButton(uint8_t id);
+    void integrateButton(uint8_t id, unsigned long timestamp);
+    void sampleButton(uint8_t id, bool active, unsigned long timestamp);
+    void settleButton(uint8_t id, unsigned long timestamp);
+    void onButtonPressed(uint8_t id);
+    void onButtonReleased(uint8_t id);
+    void onConfirm();
+    void holdButton(uint8_t id, unsigned long timestamp);
+
+    // Hold-to-repeat for UP/DOWN
+    unsigned long repeatDelay;      // 0 = off
+    unsigned long repeatInterval;
+    unsigned long repeatRamp10x;
+    unsigned long repeatRamp100x;
+    bool repeatInNavigation;
+    void repeatButton(uint8_t id, unsigned long timestamp);
+
+    // Single button
+    unsigned long longPressThreshold;
+    bool singleShortPressIsUp;
+
+    // Interrupt driven input: the GPIO ISR pushes edges into a single
+    // producer / single consumer ring that update() drains
+    // producer / single consumer ring that update() drains. Defined in the
+    // .cpp and allocated by the first enableInterruptInput().
+    struct InputQueue;
+    InputQueue* inputQueue;
+    volatile uint16_t inputQueueOverflows;
+    bool interruptInput;
+    static void handleButtonInterrupt(void* arg);
+    void processInputQueue();
+
+    // Idle policy: dim, then switch the panel off after a time without input
+    IdleState idleState;
+    unsigned long lastActivity;      // millis() of the last input
+    unsigned long dimAfter;          // 0 = never
+    unsigned long displayOffAfter;   // 0 = never
+    uint8_t activeContrast;
+    uint8_t dimContrast;
+    unsigned long idlePollInterval;  // Minimum time between polls while idle
+    unsigned long lastPoll;
+    bool lightSleepWhenOff;
+    volatile bool panelUpdatePending;   // Contrast / power save not sent yet
+    bool wakeFromIdle();
+    void wakeFromSleep();
+    void updateIdleState(unsigned long now);
+    void setIdleState(IdleState state);
+    void updatePanelState();
+    void applyPanelState();
     
-    // Rotary encoder variables (for INPUT_ENCODER mode)
-    #ifdef USE_ESP32_ENCODER
-    ESP32Encoder* encoder;
-    #else
-    InterruptEncoder* encoder;
-    #endif
-    int encoderPinA;
-    int encoderPinB;
-    int encoderButtonPin;
-    long lastEncoderValue;
-    bool encoderButtonState;
-    bool lastEncoderButtonState;
-    int encoderSensitivity;   // Number of encoder steps to register as one menu movement
-    long encoderAccumulator;  // Accumulator for encoder ticks
+    // Rotary encoder (INPUT_ENCODER mode): defined in the .cpp and
+    // allocated by the encoder constructor
+    struct EncoderInput;
+    EncoderInput* encoder;
+    uint16_t encoderAccelerationFor(long steps, unsigned long elapsedMs);
+    void resyncEncoder();
     
     // Value adjustment mode
     bool isValueAdjustMode;
     ValueAdjuster* currentValueAdjuster;
-    
-    // Debouncing
-    unsigned long lastDebounceTime;
-    unsigned long debounceDelay;
+    ValueEditor* currentEditor;      // Set with currentValueAdjuster
+    void adjustValueBy(long steps);
+    static ValueEditor* editorFor(ValueAdjuster* adjuster);
+    friend class SliderValueEditor;
+    friend class ChoiceValueEditor;
+    friend class ListValueEditor;
+
+    // Adjuster access dispatched on getKind(): the built-in kinds are read,
+    // formatted and stepped inline (ints stay ints); only custom adjusters
+    // use the virtual interface
+    enum AdjusterPart { ADJUSTER_PART_VALUE, ADJUSTER_PART_MIN, ADJUSTER_PART_MAX };
+    static uint32_t adjusterValueKey(ValueAdjuster* adjuster);
+    static uint8_t formatAdjuster(ValueAdjuster* adjuster, char* buffer, size_t size,
+                                  AdjusterPart part, bool withUnit);
+    static const char* adjusterUnit(ValueAdjuster* adjuster);
+    static int16_t adjusterMarker(ValueAdjuster* adjuster, int16_t width);
+    static void stepAdjuster(ValueAdjuster* adjuster, long steps);
+    // Raw 32-bit form of a value, as saved to NVS and sent by the remote
+    // protocol: float bits, the int / enum index, the fixed raw value, or 0/1
+    static uint32_t valueBits(ValueAdjuster* adjuster);
+    static void applyValueBits(ValueAdjuster* adjuster, uint32_t bits);
     
     // For timed operations
     unsigned long previousMillis;
     unsigned long interval;
+
+    // Render invalidation
+    bool needsRedraw;                // Set whenever the visible state changes
+    RefreshMode refreshMode;
+    uint32_t shownAdjusterKey;       // Revisions of the adjusters on screen at last draw
+    uint32_t adjusterRevisionKey(bool persistedOnly);
+
+    // Settings persistence: values are compared with what NVS holds and the
+    // changed ones written in one commit, a delay after the last change or
+    // as soon as value adjustment ends. Defined in the .cpp and allocated
+    // by the first persistValue() or setPersistence().
+    struct PersistState;
+    PersistState* persist;
+    PersistState* persistState();
+    void updatePersistence();
+
+    // Partial display updates: each drawn region keeps a content key and only
+    // the tiles of regions whose key changed are sent with updateDisplayArea()
+    enum {
+        REGION_TITLE,
+        REGION_SCROLLBAR,
+        REGION_VALUE,
+        REGION_SLIDER,
+        REGION_LABELS,
+        REGION_ROW_FIRST,
+        REGION_COUNT = REGION_ROW_FIRST + MAX_VISIBLE_ROWS
+    };
+    RenderMode renderMode;
+    bool pageBufferMode;             // Resolved from renderMode in begin()
+    bool partialUpdates;             // Allow updateDisplayArea() instead of sendBuffer()
+    // How screen pixels land in the buffer, probed by setRenderMode(). Damage
+    // is tracked in screen tiles, so partial frames need the buffer tiles
+    // to be the screen tiles (U8G2_R0, not mirrored).
+    enum { BUFFER_OTHER, BUFFER_TILES_VERTICAL, BUFFER_TILES_HORIZONTAL };
+    uint8_t bufferLayout;
+    void checkBufferLayout();
+    bool canSendPartial() const { return partialUpdates && bufferLayout != BUFFER_OTHER; }
+    bool needsFullFlush;             // Next frame must be sent completely
+    bool frameFullFlush;             // Frame being rendered is sent completely
+    uint32_t screenKey;
+    uint32_t regionKeys[REGION_COUNT];
+    uint8_t damageX0[MAX_DISPLAY_TILE_ROWS];  // Damaged tile span per tile row
+    uint8_t damageX1[MAX_DISPLAY_TILE_ROWS];
+    void beginScreen(uint32_t key);
+    void trackRegion(uint8_t region, uint32_t key, int16_t x, int16_t y, int16_t w, int16_t h);
+    void markDamage(int16_t x, int16_t y, int16_t w, int16_t h);
+    void flushFrame();
+
+    // Chunked flush: a frame is sent flushChunkRows tile rows per update()
+    uint8_t flushChunkRows;          // 0 = send frames whole
+    uint8_t flushRow;                // Next tile row to send
+    bool flushActive;                // A frame is partly sent; the buffer is held
+    void continueFlush();
+    void finishFlush();
+
+    // Frame mirroring: each frame sent to the panel is also written to the
+    // sink, as the changed tiles when a shadow copy of the last frame is kept
+    Print* mirrorSink;
+    Print* mirrorOut;                // Sink of the frame being written, nullptr until its first span
+    uint8_t* mirrorShadow;           // Allocated on first use, kept until destruction
+    bool mirrorDelta;                // Diff against the shadow; else the rows sent, raw
+    bool mirrorKeyFrame;             // Next frame writes every tile, not XORed
+    bool mirrorXor;                  // Flag of the frame being written
+    void mirrorBegin();
+    void mirrorRows(uint8_t firstRow, uint8_t rowCount, bool wholeRows);
+    void mirrorEnd();
+    void mirrorSpan(uint8_t row, uint8_t x0, uint8_t count, const uint8_t* data);
+
+    // Screen info regions: boxes redrawn over the last frame and sent on
+    // their own, without redrawing the menu
+    struct ScreenInfoRegion {
+        int menuIndex;
+        int16_t x, y, w, h;
+        ScreenInfoCallback callback;
+        unsigned long interval;      // 0 = only when marked dirty
+        unsigned long lastDraw;
+        bool dirty;
+    };
+    ScreenInfoRegion* infoRegions;   // MAX_SCREEN_INFO_REGIONS, allocated with the first
+    uint8_t infoRegionCount;
+    bool regionFramePending;         // Render task: draw the due regions only
+    bool infoRegionDue(const ScreenInfoRegion& region, unsigned long now, bool timers) const;
+    bool infoRegionsDue(unsigned long now, bool timers) const;
+    void drawInfoRegions(bool dueOnly);
+    void drawRegionFrame();
+
+    // Frame scheduling and list animation
+    unsigned long frameInterval;     // Minimum ms between frames, 0 = uncapped
+    unsigned long lastFrameTime;
+    unsigned long frameTime;         // millis() at the start of the frame being drawn
+    uint16_t animationDuration;      // 0 = animation off
+    int animationMenu;               // Menu the motions belong to
+    bool animating;                  // The last frame was still moving
+    static const int32_t MOTION_ONE = 256;   // One row in motion units
+    struct Motion {
+        int32_t from;
+        int32_t to;
+        unsigned long start;
+    };
+    Motion scrollMotion;             // First visible row
+    Motion cursorMotion;             // Cursor row
+    void snapMotion(Motion& motion, int32_t position);
+    int32_t moveMotion(Motion& motion, int32_t target);
+
+    // Drawing helpers (buffer only, no clear/send)
+    typedef void (ESP32_MenuSystem::*DrawFunction)();
+    void renderFrame(DrawFunction draw, bool allowPartial = false);
+    bool drawFrame(DrawFunction draw, bool allowPartial);  // true = flushFrame() pending
+    void drawScreen();
+    void drawMenuList();
+    void drawValueAdjust();
+    void drawBoolAdjust();
+    void drawOptionList();
+    void drawEditor();
+    void drawError();
     
+    // Optional render task: draws and flushes on another core while
+    // update() keeps handling input. The recursive mutex guards the menu
+    // state while a frame is drawn into the buffer, not while it is sent.
+    bool renderTaskEnabled;
+    BaseType_t renderTaskCore;
+    UBaseType_t renderTaskPriority;
+    uint32_t renderTaskStackSize;
+    TaskHandle_t volatile renderTaskHandle;
+    volatile bool renderTaskStopping;
+    SemaphoreHandle_t stateMutex;
+    static void renderTaskLoop(void* arg);
+    void startRenderTask();
+    void stopRenderTask();
+    void renderPending();
+    bool inRenderTask() const;
+
+    // Rolling sample windows for getStats(), defined in the .cpp and only
+    // allocated when MENU_ENABLE_STATS is set
+    enum { TIMING_INPUT, TIMING_DRAW, TIMING_FLUSH, TIMING_LATENCY, TIMING_COUNT };
+    struct TimingWindow;
+    TimingWindow* timingWindows;     // TIMING_COUNT windows
+    uint32_t framesRendered;
+    uint32_t framesSkipped;
+    bool inputPending;               // Input acted on but not yet shown
+    unsigned long inputMarkMicros;
+    bool inputDrained;               // pollInput() took edges from the queue
+    unsigned long oldestInputMillis; // Timestamp of the first of them
+    bool statsOverlay;
+    void noteInput(unsigned long timestamp);
+    void noteFrameSent();
+    void drawStatsOverlay();
+    void addSample(uint8_t id, uint32_t value);
+    void summarize(uint8_t id, MenuTiming& timing) const;
+
     // Error handling
     int errorCode;
     char errorMessage[64];
     
+    void initDefaults();
+
 public:
-    // Constructor for button mode
+    // Constructor for button mode (MENU_INPUT_BUTTONS)
     ESP32_MenuSystem(U8G2* u8g2Display, int upPin, int downPin, int okPin);
     
-    // Constructor for encoder mode
+    // Constructor for encoder mode (MENU_INPUT_ENCODER)
     ESP32_MenuSystem(U8G2* u8g2Display, int encoderA, int encoderB, int encoderBtn, bool useEncoder, int sensitivity = 1);
+
+    // Constructor for single button mode (MENU_INPUT_SINGLE_BUTTON): a short
+    // press moves down (or up), holding for the long press threshold
+    // selects / confirms
+    ESP32_MenuSystem(U8G2* u8g2Display, int buttonPin, bool shortPressIsUp = false);
+
+    // Display only view without input, e.g. a second panel showing the
+    // tree of another menu system (shareMenus())
+    explicit ESP32_MenuSystem(U8G2* u8g2Display);
     
     // Destructor
     ~ESP32_MenuSystem();
@@ -414,19 +1148,52 @@ public:
     void begin();
     
     // Menu management
+    // Menu storage: menus, items and names are packed into one arena of
+    // MENU_ARENA_SIZE bytes allocated by the constructor. Pass your own
+    // buffer before adding any menu to size it to the tree you build.
+    // Adding fails (addMenu() returns -1) once the arena is full.
+    bool useArena(uint8_t* buffer, size_t size);
+    size_t getArenaUsed() const { return model->arena.used(); }
+    size_t getArenaSize() const { return model->arena.capacity(); }
+    // Show the menu tree of another menu system instead of building one,
+    // before adding any menu (this view's own arena is released). Menus
+    // added through either are seen by both. The owner must outlive this
+    // view; with render tasks, build the tree before begin().
+    bool shareMenus(ESP32_MenuSystem& owner);
+
     int addMenu(const char* title);
-    void addMenuItem(int menuIndex, const char* name, int nextMenuId = -1, MenuCallback* callback = nullptr);
-    void addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster);
+    // Constant menus: the items (and title) are not copied, so they must
+    // outlive the menu system. Declared constexpr they stay in flash and
+    // only a small Menu record uses RAM; addMenuItem() rejects them.
+    int addStaticMenu(const char* title, const MenuItem* items, int count, int id = -1);
+    template <size_t N>
+    int addStaticMenu(const char* title, const MenuItem (&items)[N], int id = -1) {
+        return addStaticMenu(title, items, (int)N, id);
+    }
+    // Add a whole table of menus; false if they did not all fit
+    bool addMenuTree(const MenuDefinition* definitions, int count);
+    // Menu whose entries come from a data source (any length, constant
+    // RAM). The source must outlive the menu system; call invalidate()
+    // after its entries change.
+    int addListMenu(const char* title, MenuDataSource* source, int id = -1);
+    // The addMenuItem() family returns false and adds nothing when the
+    // arena is full, or the menu does not exist, is constant or is a list
+    bool addMenuItem(int menuIndex, const char* name, int nextMenuId = -1, MenuCallback* callback = nullptr);
+    bool addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster);
+    // With its own edit screen; the editor must outlive the menu system
+    bool addValueMenuItem(int menuIndex, const char* name, ValueAdjuster* adjuster, ValueEditor* editor);
     void setMenuMaxVisibleItems(int menuIndex, int maxItems);
 
     // Screen size customization
     void setScreenSize(uint16_t width, uint16_t height);
     uint16_t getScreenWidth() const { return screenWidth; }
     uint16_t getScreenHeight() const { return screenHeight; }
+    U8G2* getDisplay() const { return display; }
     // Set the padding between menu items
     void setMenuItemPadding(uint8_t padding) { 
     menuItemPadding = padding; 
-    updateLayoutForFonts(); } // Recalculate layout with new padding
+    updateLayoutForFonts();  // Recalculate layout with new padding
+    invalidate(); }
 
     // Display offset configuration
     void setDisplayOffset(int16_t x, int16_t y);
@@ -446,10 +1213,27 @@ public:
                                 
     void setButtonTrigger(ButtonID buttonId, ButtonTriggerType triggerType);
 
+    // Debounce configuration (each button debounces independently)
+    void setDebounceDelay(unsigned long delayMs);                    // All buttons
+    void setDebounceDelay(ButtonID buttonId, unsigned long delayMs);
+    void setDebounceMode(DebounceMode mode);                         // All buttons
+    void setDebounceMode(ButtonID buttonId, DebounceMode mode);
+
+    // Hold-to-repeat for UP/DOWN while adjusting a value (and optionally
+    // in menu lists). delayMs = 0 disables it. Default: 500ms, then every 100ms.
+    // (MENU_INPUT_BUTTONS)
+    void setButtonRepeat(unsigned long delayMs, unsigned long intervalMs, bool inNavigation = false);
+    // Hold time after which each repeat moves 10x / 100x the increment
+    // (default 2000ms / 4000ms)
+    void setButtonRepeatRamp(unsigned long tenXAfterMs, unsigned long hundredXAfterMs);
+
+    // Single button: hold time that counts as a long press (default 3000ms)
+    void setLongPressThreshold(unsigned long thresholdMs) { longPressThreshold = thresholdMs; }
+
     // Font
-    void setStandardFont(const uint8_t* font) { standardFont = font; }
-    void setTitleFont(const uint8_t* font) { titleFont = font; }
-    void setValueFont(const uint8_t* font) { valueFont = font; }
+    void setStandardFont(const uint8_t* font) { standardFont = font; cacheFontMetrics(); invalidate(); }
+    void setTitleFont(const uint8_t* font) { titleFont = font; cacheFontMetrics(); invalidate(); }
+    void setValueFont(const uint8_t* font) { valueFont = font; cacheFontMetrics(); invalidate(); }
     
     const uint8_t* getStandardFont() const { return standardFont; }
     const uint8_t* getTitleFont() const { return titleFont; }
@@ -459,25 +1243,81 @@ public:
         standardFont = standard;
         titleFont = title;
         valueFont = value;
+        cacheFontMetrics();
+        invalidate();
     }
     
     // Navigation
     void moveUp();
     void moveDown();
     void select();
+    // Opening a menu (select() or setCurrentMenu()) remembers the current
+    // view; goBack() restores it (menu, cursor and scroll position). Opening
+    // a menu that is already in the history returns to that level instead.
     void goBack();
     void setCurrentMenu(int menuId);
+    uint8_t getNavigationDepth() const { return navigationDepth; }
+    void clearNavigationHistory() { navigationDepth = 0; }
     int getCursorPosition() const { return cursorPosition; }
     int getCurrentMenuId() const;
     
     // Input handling
     void checkButtons();
+    // Encoder (MENU_INPUT_ENCODER)
     void handleEncoderMovement();
     void handleButtonPress();
+
+    // Encoder acceleration for value adjusting: the turning rate picks a
+    // multiplier from the curve (ascending minRate). count = 0 disables it.
+    // Default: 10/s -> x4, 25/s -> x16, 50/s -> x64.
+    void setEncoderAcceleration(const EncoderAccelerationStep* steps, uint8_t count);
+    InputMode getInputMode() const;
+
+    // Binary remote control (MENU_INPUT_REMOTE) (see RemoteCommand). update() reads command
+    // frames from the stream and, with replies on, answers each with a
+    // state delta. nullptr turns it off.
+    void setRemoteControl(Stream* stream, bool replies = true);
+    // Feed received bytes directly, e.g. a UDP datagram; replies go to
+    // reply (nullptr = none). Call outside update().
+    void handleRemoteData(const uint8_t* data, size_t length, Print* reply = nullptr);
+
+    // Interrupt driven buttons: edges are queued with their timestamp by a
+    // GPIO interrupt and handled on the next update(), so presses are not
+    // missed while loop() is busy. The encoder itself is already counted in
+    // hardware/interrupts.
+    void enableInterruptInput(bool enable = true);
+    bool isInterruptInputEnabled() const { return interruptInput; }
+    uint16_t getInputQueueOverflows() const { return inputQueueOverflows; }
+
+    // Idle policy: after dimAfterMs without input the contrast is lowered and
+    // timed refreshes stop; after displayOffAfterMs the panel goes into power
+    // save and nothing is drawn (0 = never). The press or encoder movement
+    // that wakes a switched off display only wakes it.
+    void setIdleTimeouts(unsigned long dimAfterMs, unsigned long displayOffAfterMs);
+    void setIdleContrast(uint8_t active, uint8_t dimmed);   // Default 255 / 16
+    void setIdlePollInterval(unsigned long intervalMs);     // Polling while idle (default 20ms)
+    // Enter light sleep from update() while the panel is off
+    void setLightSleepWhenOff(bool enable) { lightSleepWhenOff = enable; }
+    // Light sleep until a menu button / the encoder is used or timeoutUs
+    // passes (0 = no timeout). Returns false if no wake pin is configured.
+    bool lightSleep(uint64_t timeoutUs = 0);
+    void wake();    // Count as input: restore the display
+    IdleState getIdleState() const { return idleState; }
+    unsigned long getIdleTime() const { return millis() - lastActivity; }
     
-    // Value adjustment
-    void enterValueAdjustMode(ValueAdjuster* adjuster);
+    // Value adjustment (editor nullptr = the built-in one for the adjuster)
+    void enterValueAdjustMode(ValueAdjuster* adjuster, ValueEditor* editor = nullptr);
     void exitValueAdjustMode();
+
+    // Settings persistence (NVS). Register adjusters before begin(), which
+    // loads their saved values. Changed values are saved together in one
+    // commit, delayMs after the last change or when value adjustment ends.
+    // The key (up to 15 chars) is not copied. Returns false when all
+    // MAX_PERSISTED_VALUES are taken or the key is too long.
+    bool persistValue(ValueAdjuster* adjuster, const char* key);
+    void setPersistence(const char* nvsNamespace, unsigned long delayMs = 2000);
+    bool loadSettings();
+    bool saveSettings();    // Write the changed values now (e.g. before deep sleep)
     
     // Display
     void displayMenu();
@@ -485,6 +1325,72 @@ public:
     void displayBoolAdjust();
     void displayError();
     void addScreenInfo(int menuIndex, ScreenInfoCallback callback);
+    // Screen info drawn inside a box (screen pixels) and refreshed on its
+    // own: every intervalMs (0 = never) and after markDirty(), only that
+    // box is redrawn and sent. Returns the region id, or -1 when all
+    // MAX_SCREEN_INFO_REGIONS are taken.
+    int addScreenInfoRegion(int menuIndex, int16_t x, int16_t y, int16_t w, int16_t h,
+                            ScreenInfoCallback callback, unsigned long intervalMs = 0);
+    void markDirty(int region);
+
+    // Rendering control
+    // displayMenu() only redraws and sends the frame when the screen is dirty.
+    // Navigation, value changes and errors mark it dirty automatically; call
+    // invalidate() after changing anything else that is shown (e.g. a value
+    // written directly through the adjuster's pointer, or a data source
+    // whose entries changed).
+    void invalidate() { needsRedraw = true; needsFullFlush = true; listCacheMenu = -1; }
+    bool isDirty() const { return needsRedraw; }
+    void setRefreshMode(RefreshMode mode, unsigned long intervalMs = 1000);
+    RefreshMode getRefreshMode() const { return refreshMode; }
+    // Full or page buffer rendering. RENDER_AUTO (default) picks page mode for
+    // the U8G2 _1/_2 constructors; screen info callbacks then run once per page.
+    void setRenderMode(RenderMode mode);
+    RenderMode getRenderMode() const { return renderMode; }
+    bool isPageBufferMode() const { return pageBufferMode; }
+    // Send only the changed tile rows with updateDisplayArea() (default on,
+    // full buffer mode only). With a rotated or mirrored display (anything
+    // but U8G2_R0) begin() finds that buffer tiles are not screen tiles and
+    // whole frames are sent. Call begin() again after setDisplayRotation().
+    void setPartialUpdates(bool enable);
+    bool getPartialUpdates() const { return partialUpdates; }
+    // Send frames a few tile rows per update() with updateDisplayArea()
+    // (full buffer mode), so long transfers on big panels
+    // don't stall loop(). No new frame is drawn until the previous one is
+    // out. 0 = send each frame at once (default).
+    void setChunkedFlush(uint8_t tileRowsPerUpdate);
+    bool isFlushing() const { return flushActive; }
+    // Also write every frame sent to the panel to sink (Serial, a
+    // WebSocket client...), see MIRROR_SYNC for the format. With delta, a
+    // shadow of the buffer (tile columns x tile rows x 8 bytes) is kept and
+    // only changed tiles are written, XORed against the previous frame.
+    // Without it, the rows sent to the panel are written as they are.
+    // Returns false if the shadow cannot be allocated. nullptr stops it.
+    bool setMirror(Print* sink, bool delta = true);
+    // Write the next frame in full, e.g. when a viewer connects
+    void requestMirrorKeyFrame() { mirrorKeyFrame = true; needsRedraw = true; }
+    // Draw at most fps frames per second; changes in between are drawn
+    // together in the next frame (0 = uncapped, default).
+    void setFrameRate(uint8_t fps);
+    // Glide the list and the cursor to their new rows over durationMs
+    // (ease-out, 0 = off). Frames are only drawn while something moves.
+    void setAnimation(uint16_t durationMs);
+    bool isAnimating() const { return animating; }
+    // Draw and send frames from a FreeRTOS task pinned to `core` (call before
+    // begin()), so update() never waits on the display bus. Changes made
+    // outside update() while it runs (adding items, setting values, drawing
+    // on the display yourself) must be wrapped in lockState()/unlockState().
+    void setRenderTask(bool enable, BaseType_t core = 0, UBaseType_t priority = 1,
+                       uint32_t stackSize = 4096);
+    bool isRenderTaskRunning() const { return renderTaskHandle != nullptr; }
+    void lockState();
+    void unlockState();
+
+    // Timing and frame counters (build with MENU_ENABLE_STATS)
+    MenuStats getStats();
+    void resetStats();
+    // Draw the average draw/flush time and latency in the bottom right corner
+    void setStatsOverlay(bool enable);
     
     // Error handling
     void setError(int code, const char* message);
@@ -493,20 +1399,27 @@ public:
     // Main update function to call in loop()
     void update();
     // Add this to the public section of ESP32_MenuSystem class
-    void addMenuItemWithFunction(int menuIndex, const char* name, SimpleMenuFunction function, int nextMenuId = -1) {
-        if (menuIndex >= 0 && menuIndex < menuCount) {
-            // Create a new FunctionCallback (will be managed by the library)
-            FunctionCallback* callback = new FunctionCallback(function);
-        
-            // Add the menu item with this callback
-            menus[menuIndex].addItem(name, nextMenuId, callback);
-        }
+    // The function is stored in the item itself, nothing is allocated
+    bool addMenuItemWithFunction(int menuIndex, const char* name, SimpleMenuFunction function, int nextMenuId = -1) {
+        return appendMenuItem(menuIndex, MenuItem(name, function, nextMenuId));
+    }
+    // Same with a context pointer passed back to the function (an object,
+    // a channel number cast to void*...). The context is not owned.
+    bool addMenuItemWithContext(int menuIndex, const char* name, ContextMenuFunction function, void* context, int nextMenuId = -1) {
+        return appendMenuItem(menuIndex, MenuItem(name, function, context, nextMenuId));
     }
 
     typedef void (*ScreenInfoCallback)();
     
+    // Value formatting without printf: raw / 10^decimals, and floats rounded
+    // to the adjuster's decimal places. Both return the written length.
+    static uint8_t formatFixed(char* buffer, size_t size, int64_t raw, uint8_t decimals);
+    static uint8_t formatValue(char* buffer, size_t size, float value, int decimals);
+
     // Helper functions
     int findMenuById(int id);
+    // Points into the arena: adding a menu or an item may move the
+    // directory or the menu's items, so don't keep it across adds
     Menu* getCurrentMenu();
 };
 